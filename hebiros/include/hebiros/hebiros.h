@@ -52,12 +52,15 @@
 #include "hebiros_publishers_gazebo.h"
 #include "hebiros_publishers_physical.h"
 #include "hebiros_clients.h"
+#include "hebiros_shm_transport.h"
 #include "hebiros_actions.h"
 #include "hebiros_group.h"
 #include "hebiros_group_gazebo.h"
 #include "hebiros_group_physical.h"
+#include "hebiros_group_sim.h"
 #include "hebiros_parameters.h"
 #include "hebiros_model.h"
+#include "hebiros_urdf_cache.h"
 
 #include <iostream>
 #include <chrono>
@@ -83,15 +86,25 @@ class HebirosNode {
     static HebirosServicesGazebo services_gazebo;
     static HebirosServicesPhysical services_physical;
     static HebirosClients clients;
+    static HebirosShmTransport shm_transport;
     static HebirosActions actions;
 
     bool use_gazebo;
+    // Simulate groups in this node instead of Gazebo; implies use_gazebo
+    static bool use_sim;
+    // Back physical groups with imitation groups of the requested size, which
+    // return their commands as feedback; no modules are needed
+    static bool use_imitation;
 
     HebirosNode(int argc, char **argv);
 
     void cleanup();
 
     void loop();
+
+    // Steps the simulated groups in simulated time, as fast as possible or at
+    // "hebiros/sim_real_time_factor" times real time, and publishes /clock
+    void simulate();
 };
 
 #endif
@@ -2,10 +2,19 @@
 #define HEBIROS_ACTIONS_H
 
 #include "ros/ros.h"
+#include "actionlib/server/action_server.h"
 #include "actionlib/server/simple_action_server.h"
 
+#include "hebiros/AddGroupAction.h"
+#include "hebiros/AddGroupFromNamesSrv.h"
 #include "hebiros/TrajectoryAction.h"
 
+#include "group.hpp"
+
+#include "hebiros_worker_pool.h"
+
+#include <map>
+
 
 class HebirosActions {
 
@@ -15,9 +24,29 @@ class HebirosActions {
       std::shared_ptr<actionlib::SimpleActionServer<hebiros::TrajectoryAction>>>
       trajectory_actions;
 
+    // Advertises hebiros/add_group, which adds groups like
+    // add_group_from_names and add_group_from_urdf without blocking the node:
+    // the lookups of several goals run at once on a worker pool, and each
+    // group is registered on the callback thread once it is found
+    void registerNodeActions();
     void registerGroupActions(std::string group_name);
+    void stop();
+
+    void addGroup(actionlib::ServerGoalHandle<hebiros::AddGroupAction> goal);
+    void finishAddGroup(actionlib::ServerGoalHandle<hebiros::AddGroupAction> goal,
+      hebiros::AddGroupFromNamesSrv::Request req,
+      std::map<std::string, std::string> joint_full_names,
+      std::shared_ptr<hebi::Group> group_ptr);
     void trajectory(const hebiros::TrajectoryGoalConstPtr& goal, std::string group_name);
 
+  private:
+
+    std::shared_ptr<actionlib::ActionServer<hebiros::AddGroupAction>> add_group_action;
+    HebirosWorkerPool lookup_pool;
+    // Goals whose lookup has not finished, by group name; only used on the
+    // callback thread
+    std::map<std::string, actionlib::ServerGoalHandle<hebiros::AddGroupAction>> pending_groups;
+
 };
 
 #endif
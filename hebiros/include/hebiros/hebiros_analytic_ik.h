@@ -0,0 +1,64 @@
+#ifndef HEBIROS_ANALYTIC_IK_H
+#define HEBIROS_ANALYTIC_IK_H
+
+#include "Eigen/Eigen"
+
+#include <memory>
+#include <vector>
+
+class HebirosModel;
+
+// Closed form inverse kinematics for the common arm layout of a base joint, two
+// parallel joints (shoulder and elbow), and a wrist of two or three joints
+// whose axes intersect in one point; i.e., the standard 5 and 6 DoF arms with
+// a wrist that does not offset the end effector from its axes. The solver
+// only stores the model's joint axes (at zero positions), so it can be used
+// independently of the model it was created from.
+class HebirosAnalyticIK {
+
+  public:
+
+    // Returns a solver if the model has this layout, otherwise nullptr.
+    static std::unique_ptr<HebirosAnalyticIK> create(const HebirosModel& model);
+
+    // Computes every solution branch (up to two each for the base, elbow and
+    // a 3 joint wrist) placing the end effector at the target frame, in the
+    // model's base frame. Positions are wrapped to [-pi, pi]. Returns false if
+    // there is no exact solution.
+    bool solve(const Eigen::Matrix4d& target, std::vector<Eigen::VectorXd>& solutions) const;
+
+    // End effector frame at the given positions
+    Eigen::Matrix4d getEndEffector(const Eigen::VectorXd& positions) const;
+
+  private:
+
+    HebirosAnalyticIK() = default;
+
+    // Appends the solutions for the wrist joints, given the base, shoulder and
+    // elbow positions in "positions"
+    void solveWrist(const Eigen::Matrix3d& rotation, Eigen::VectorXd positions,
+      std::vector<Eigen::VectorXd>& solutions) const;
+
+    size_t dof_count;
+
+    // Axis of each joint, and a point on that axis, at zero positions
+    std::vector<Eigen::Vector3d> axes;
+    std::vector<Eigen::Vector3d> points;
+
+    // Intersection of the wrist axes, and end effector frame, at zero
+    // positions
+    Eigen::Vector3d wrist_center;
+    Eigen::Matrix4d end_effector;
+
+    // Shoulder/elbow plane (perpendicular to the shoulder axis) basis, and the
+    // shoulder, elbow and wrist center positions projected onto it
+    Eigen::Vector3d plane_x;
+    Eigen::Vector3d plane_y;
+    Eigen::Vector2d shoulder;
+    Eigen::Vector2d elbow;
+    Eigen::Vector2d wrist;
+    // 1 if the elbow axis points the same way as the shoulder axis, else -1
+    double elbow_direction;
+};
+
+#endif
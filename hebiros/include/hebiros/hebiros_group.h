@@ -5,6 +5,10 @@
 
 #include "hebiros/FeedbackMsg.h"
 
+#include "hebiros_group_model.h"
+
+#include <mutex>
+
 // Base class for physical and simulated groups of modules.
 class HebirosGroup {
 
@@ -17,7 +21,16 @@ class HebirosGroup {
     std::map<std::string, std::string> joint_full_names;
     std::map<std::string, int> joints;
     sensor_msgs::JointState joint_state_msg;
-    hebiros::FeedbackMsg feedback_msg;
+    // Last feedback, shared with the subscribers it was published to
+    hebiros::FeedbackMsg::ConstPtr feedback_msg;
+    // Feedback joint state with the joints' URDF names; reused for every
+    // feedback
+    sensor_msgs::JointState joint_state_urdf_msg;
+
+    // Optional model of this group, set through the "set_model" service.
+    // Feedback may arrive on another thread, so lock model_mutex to use it.
+    std::unique_ptr<HebirosGroupModel> model;
+    std::mutex model_mutex;
 
     virtual void setFeedbackFrequency(float frequency_hz);
     virtual void setCommandLifetime(float lifetime_ms);
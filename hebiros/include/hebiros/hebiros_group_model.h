@@ -0,0 +1,194 @@
+#pragma once
+
+#include "ros/ros.h"
+#include "sensor_msgs/JointState.h"
+#include "geometry_msgs/PoseStamped.h"
+#include "geometry_msgs/Twist.h"
+#include "geometry_msgs/WrenchStamped.h"
+#include "tf2_msgs/TFMessage.h"
+
+#include "hebiros/FeedbackMsg.h"
+#include "hebiros/CommandMsg.h"
+
+#include "hebiros_model.h"
+#include "trajectory.hpp"
+
+class HebirosGroup;
+
+// A model associated with a group, with the state needed to evaluate the model
+// from the group's feedback. All buffers are allocated once, when the model is
+// associated, and reused for every feedback update.
+class HebirosGroupModel {
+
+  public:
+
+    // Matches the model's joints to the group's joints by name; check isValid
+    // before use.
+    HebirosGroupModel(const HebirosModel& model_, const HebirosGroup& group);
+
+    // True if every model joint was found in the group.
+    bool isValid() const;
+
+    const HebirosModel& getModel() const;
+
+    // Group joint index of each model joint, in model joint order
+    const std::vector<int>& getJointIndices() const;
+
+    // Copies the positions from a feedback message (in group order) into
+    // model joint order; returns false if the message does not match the
+    // group.
+    bool setPositions(const hebiros::FeedbackMsg& feedback_msg);
+
+    const Eigen::VectorXd& getPositions() const;
+
+    // Recomputes tf_msg and end_effector_msg from the last positions, once
+    // every "hebiros/model_feedback_decimation" calls. Returns true if the
+    // messages were updated.
+    bool updateFrames(const ros::Time& stamp);
+
+    // When enabled, commands are held by setCommand and sent by the feedback
+    // handler with efforts that compensate for gravity added.
+    void setGravityCompensation(bool enabled);
+    bool getGravityCompensation() const;
+
+    // Computes the joint efforts that hold the model against gravity at the
+    // positions in the feedback message. Gravity is measured by the IMU of the
+    // first joint's module, or assumed to be -z if there is no IMU data.
+    bool updateGravityEfforts(const hebiros::FeedbackMsg& feedback_msg);
+
+    // Efforts from the last updateGravityEfforts call, in model joint order
+    const Eigen::VectorXd& getGravityEfforts() const;
+
+    // Holds a joint command (and optionally settings) to be merged with the
+    // gravity efforts; returns false if gravity compensation is disabled.
+    bool setCommand(const sensor_msgs::JointState& joint_state_msg,
+      const hebiros::SettingsMsg* settings_msg);
+
+    // Returns the held command (in group order), if it has not expired, plus
+    // the gravity efforts. Unset fields are NaN, or for positions and
+    // velocities, taken from "hold_feedback" if given. Held settings are only
+    // returned once.
+    const hebiros::CommandMsg& getCommand(const hebiros::FeedbackMsg* hold_feedback = nullptr);
+
+    // Sets the end effector velocity to follow, in the model's base frame.
+    // Only supported for models without branches.
+    bool setTwist(const geometry_msgs::Twist& twist_msg);
+
+    // Maps the last twist to joint velocities with a damped least squares
+    // inverse of the end effector Jacobian at the last feedback positions, and
+    // integrates them into twist_command_msg. The integrated positions start
+    // from the feedback positions whenever a twist starts. Returns false if
+    // there is no twist, or it is older than "hebiros/command_lifetime".
+    bool updateTwistCommand(const ros::Time& time);
+
+    // Position and velocity command for the model joints
+    sensor_msgs::JointState twist_command_msg;
+
+    // Estimates the wrench that the end effector applies to its environment
+    // from the joint efforts in the feedback message, by solving
+    // J^T * F = effort - gravity efforts in the damped least squares sense,
+    // and low pass filters it into wrench_msg. Uses the gravity efforts from
+    // the last updateGravityEfforts call. Only supported for models without
+    // branches.
+    bool updateWrench(const hebiros::FeedbackMsg& feedback_msg, const ros::Time& stamp);
+
+    // Filtered end effector wrench, in the model's base frame
+    geometry_msgs::WrenchStamped wrench_msg;
+
+    // Checks the model's link capsules for self-collision at every
+    // "resolution" seconds of a trajectory (in group joint order), and at its
+    // end. Returns false, with a description of the first collision found, if
+    // any links collide; models without collision geometry always pass.
+    bool checkTrajectory(const hebi::trajectory::Trajectory& trajectory,
+      double resolution, double mesh_radius, std::string& collision);
+
+    // Frame of every link relative to the model's base link
+    tf2_msgs::TFMessage tf_msg;
+
+    // The last output frame of the model; for trees, this is the end of the
+    // last branch.
+    geometry_msgs::PoseStamped end_effector_msg;
+
+  private:
+
+    const HebirosModel& model;
+
+    // Group joint index for each model joint, or -1 if not in the group
+    std::vector<int> joint_indices;
+
+    // Group joint names, by group joint index
+    std::vector<std::string> group_joint_names;
+    std::map<std::string, int> group_joints;
+
+    Eigen::VectorXd positions;
+    hebi::robot_model::Matrix4dVector output_frames;
+    hebi::robot_model::Matrix4dVector link_frames;
+    HebirosModel::FKWorkspace fk_workspace;
+
+    int decimation;
+    int decimation_count;
+
+    // Per chain workspace for gravity compensation
+    struct ChainState {
+      Eigen::VectorXd positions;
+      Eigen::VectorXd masses;
+      hebi::robot_model::Matrix4dVector com_frames;
+      hebi::robot_model::MatrixXdVector com_jacobians;
+      // End of the chain and its Jacobian, only computed for chains with
+      // children
+      Eigen::Matrix4d end;
+      Eigen::MatrixXd end_jacobian;
+      // World transform of the frame this chain's model is relative to
+      Eigen::Matrix4d reference;
+      // Gravity load of all child chains, in world coordinates, about the
+      // end of this chain
+      Eigen::Vector3d force;
+      Eigen::Vector3d moment;
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+    std::vector<ChainState, Eigen::aligned_allocator<ChainState>> chain_states;
+
+    bool gravity_compensation;
+    // Rotation of the first joint's module housing relative to the world
+    Eigen::Matrix3d imu_rotation;
+    Eigen::VectorXd gravity_efforts;
+
+    // Held command, in group order
+    std::vector<double> command_position;
+    std::vector<double> command_velocity;
+    std::vector<double> command_effort;
+    ros::Time command_time;
+    hebiros::SettingsMsg command_settings;
+    hebiros::CommandMsg command_msg;
+
+    // Twist command state; the solver matrices are sized once
+    Eigen::Matrix<double, 6, 1> twist;
+    ros::Time twist_time;
+    ros::Time twist_update_time;
+    bool twist_active;
+    Eigen::VectorXd twist_positions;
+    Eigen::VectorXd twist_velocities;
+    Eigen::MatrixXd twist_jacobian;
+    Eigen::Matrix<double, 6, 6> twist_jjt;
+    Eigen::LDLT<Eigen::Matrix<double, 6, 6>> twist_solver;
+
+    // Wrench estimate state; the solver matrices are sized once
+    Eigen::VectorXd wrench_efforts;
+    Eigen::MatrixXd wrench_jacobian;
+    Eigen::Matrix<double, 6, 6> wrench_jjt;
+    Eigen::LDLT<Eigen::Matrix<double, 6, 6>> wrench_solver;
+    Eigen::Matrix<double, 6, 1> wrench;
+    Eigen::Matrix<double, 6, 1> wrench_filtered;
+    ros::Time wrench_time;
+
+    // Self-collision check workspace; joint positions of all trajectory
+    // samples (one per column, in model joint order), then link frames and
+    // capsule end points for one sample at a time
+    Eigen::VectorXd collision_group_positions;
+    Eigen::MatrixXd collision_positions;
+    Eigen::VectorXd collision_sample;
+    hebi::robot_model::Matrix4dVector collision_output_frames;
+    hebi::robot_model::Matrix4dVector collision_link_frames;
+    HebirosModel::FKWorkspace collision_fk_workspace;
+    std::vector<Eigen::Vector3d> collision_points;
+};
@@ -10,6 +10,9 @@ class HebirosGroupPhysical : public HebirosGroup {
 
     std::shared_ptr<hebi::Group> group_ptr;
     hebi::GroupInfo group_info;
+    // "family/name" of each module, in group order; from the modules' info,
+    // or from the requested joints for imitation groups
+    std::vector<std::string> module_names;
 
     HebirosGroupPhysical(std::shared_ptr<hebi::Group> group);
     virtual ~HebirosGroupPhysical();
@@ -2,6 +2,8 @@
 
 #include "hebiros_group.h"
 
+#include <functional>
+
 namespace hebiros {
 
   // This class contains a list of named groups.
@@ -23,6 +25,9 @@ namespace hebiros {
 
     bool hasGroup(const std::string& name) const;
 
+    // Calls the given function with the name and group of each group.
+    void forEachGroup(const std::function<void(const std::string&, HebirosGroup&)>& f);
+
   private:
 
     // Note -- after refactoring so this isn't a singleton, this should probably
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "hebiros/CommandMsg.h"
+#include "hebiros/FeedbackMsg.h"
+#include "hebiros/SettingsMsg.h"
+
+#include "hebiros_group_gazebo.h"
+#include "sim/hebiros_actuator_controller.h"
+#include "sim/hebiros_actuator_settings.h"
+
+// A group simulated by the node itself, without Gazebo ("-use_sim true"). Its
+// actuators run the same model as the Gazebo plugin (control strategies, motor
+// and temperature model; see hebiros::sim::ActuatorController), and their
+// joints are integrated by the node in simulated time.
+//
+// If the group has a model without branches (set_model service), the joints
+// are coupled through the model's mass matrix and loaded by gravity;
+// otherwise each joint only moves the reflected inertia of its actuator.
+// Coriolis and centrifugal forces are not modeled.
+//
+// The rest of the node handles this like a Gazebo group: feedback goes through
+// the same handler, and commands that would be published to the plugin are
+// given to setCommand instead.
+class HebirosGroupSim : public HebirosGroupGazebo {
+
+  public:
+
+    HebirosGroupSim();
+
+    // Sets up the simulated joints once the group's joints are known (see
+    // HebirosServices::addGroup)
+    void initialize();
+
+    // Takes a command, as the plugin does when one is published to it
+    void setCommand(const hebiros::CommandMsg& command_msg, const ros::Time& time);
+
+    void setFeedbackFrequency(float frequency_hz) override;
+    void setCommandLifetime(float lifetime_ms) override;
+
+    // Advances the group by dt seconds, to "time"; returns true if feedback is
+    // due, in which case getFeedback has the new feedback.
+    bool step(double dt, const ros::Time& time);
+
+    const hebiros::FeedbackMsg& getFeedback() const;
+
+    // The actuator model, for state that feedback does not report
+    const hebiros::sim::ActuatorController& getController() const;
+
+  private:
+
+    hebiros::sim::ActuatorController controller;
+    hebiros::CommandMsg command_target;
+    hebiros::SettingsMsg settings;
+    // Default gains of each joint's model, by feedback index
+    std::vector<const hebiros::sim::ActuatorSettings::GainsTable*> default_gains;
+    // Index in the last command of each joint, by feedback index
+    std::vector<int> command_indices;
+
+    int command_lifetime;
+    int feedback_frequency;
+    ros::Time start_time;
+    ros::Time prev_feedback_time;
+    hebiros::FeedbackMsg sim_feedback;
+
+    // Joint state, and the force applied over the last step
+    Eigen::VectorXd positions;
+    Eigen::VectorXd velocities;
+    Eigen::VectorXd efforts;
+
+    // Inertia and viscous friction of each actuator's rotor, at the output
+    Eigen::VectorXd reflected_inertia;
+    Eigen::VectorXd damping;
+
+    // Dynamics workspace, sized once; "dynamics_model" is the model the model
+    // workspace was set up for
+    Eigen::MatrixXd mass_matrix;
+    Eigen::VectorXd momentum;
+    Eigen::LDLT<Eigen::MatrixXd> solver;
+    const HebirosModel* dynamics_model;
+    Eigen::VectorXd model_positions;
+    Eigen::MatrixXd model_mass_matrix;
+    Eigen::VectorXd model_gravity;
+    Eigen::VectorXd masses;
+    std::vector<Eigen::Matrix3d> inertias;
+    hebi::robot_model::Matrix4dVector com_frames;
+    hebi::robot_model::MatrixXdVector com_jacobians;
+
+    // Adds the mass matrix and gravity forces of the group's model, if it has
+    // one without branches, to mass_matrix and momentum (scaled by dt)
+    void addModelDynamics(double dt);
+};
@@ -5,34 +5,199 @@
 #include "urdf/model.h"
 #include "robot_model.hpp"
 
+#include <istream>
+
+#include "hebiros_analytic_ik.h"
+#include "hebiros_reachability_map.h"
+
 class HebirosModel {
 
   public:
+    // A single element (rigid body or joint) of a chain. This is enough to
+    // rebuild the HEBI robot model without the URDF. Transforms are 4x4 row
+    // major arrays, matching the C API.
+    struct Element {
+      enum class Type : uint8_t { RigidBody = 0, Joint = 1 };
+      Type type;
+      HebiJointType joint_type;
+      double com[16];
+      double inertia[6];
+      double mass;
+      double output[16];
+    };
+
+    // Collision geometry of a link, approximated by a capsule: all points
+    // within "radius" of the segment from "a" to "b" (in the link's frame).
+    // Links with mesh collision geometry get a segment from their frame to
+    // each child joint, with a negative radius; the mesh radius given to
+    // findSelfCollision is used for these instead.
+    struct Capsule {
+      // Index of the link's rigid body element in its chain
+      uint32_t element;
+      double a[3];
+      double b[3];
+      double radius;
+    };
+
+    // One kinematic chain of a (possibly tree structured) model. The HEBI
+    // robot model only supports chains, so a URDF tree is split into one chain
+    // per branch; each chain's base frame is relative to the end of its parent
+    // chain (or to the world for the root chain).
+    struct Chain {
+      std::unique_ptr<hebi::robot_model::RobotModel> model;
+      // Index of the parent chain, or -1 for the root chain
+      int parent;
+      double base_frame[16];
+      std::vector<Element> elements;
+      // URDF link name of each rigid body and URDF joint name of each joint,
+      // parallel to "elements"
+      std::vector<std::string> element_names;
+      std::vector<Capsule> capsules;
+      // Index of the first joint of this chain in the full joint vector
+      size_t dof_offset;
+      size_t dof_count;
+      bool has_children;
+    };
+
     // Tries to read the model from the robot description parameter. Add to the
     // set of models and returns true on success, otherwise returns false.
+    //
+    // If "hebiros/model_snapshot_dir" is set, the parsed model is stored there
+    // and later loads of an unchanged description skip URDF parsing entirely.
     static bool load(const std::string& name, const std::string& description_param);
 
-    // Technically, this is only used by this class, but it is used by the 
+    // Technically, this is only used by this class, but it is used by the
     // std::map contained herein, so it has to be public
-    HebirosModel(std::unique_ptr<hebi::robot_model::RobotModel> model_);
+    HebirosModel(std::vector<Chain> chains_, std::string base_name_);
 
     static HebirosModel* getModel(const std::string& model_name);
 
+    // Builds a model from a URDF without adding it to the set of models;
+    // returns nullptr on failure.
+    static std::unique_ptr<HebirosModel> fromURDF(const urdf::Model& urdf);
+
+    // Returns the root chain of the model; for models without branches, this
+    // is the entire model.
     hebi::robot_model::RobotModel& getModel();
+    const hebi::robot_model::RobotModel& getModel() const;
+
+    const std::vector<Chain>& getChains() const;
+
+    // True if the model has no branches (and so is fully described by getModel)
+    bool isChain() const;
+
+    size_t getDoFCount() const;
+
+    // Reachability map of the end effector, if one was found when loading the
+    // model (see "hebiros/reachability_map_dir"); otherwise nullptr.
+    const HebirosReachabilityMap* getReachabilityMap() const;
+    void setReachabilityMap(std::unique_ptr<HebirosReachabilityMap> map);
+
+    // Solves for joint positions that place the end effector at the target
+    // frame (in the model's base frame). Models with the layout supported by
+    // HebirosAnalyticIK get all solutions, ordered by distance from the
+    // initial positions, and "analytic" is set; otherwise, this falls back to
+    // the numeric solver started from the initial positions. Only supported
+    // for models without branches.
+    bool solveIK(const Eigen::Matrix4d& target, const Eigen::VectorXd& initial_positions,
+      std::vector<Eigen::VectorXd>& solutions, bool& analytic) const;
+
+    size_t getFrameCount(HebiFrameType frame_type) const;
+
+    // Name of the URDF root link; all frames are relative to this.
+    const std::string& getBaseName() const;
+
+    // URDF names of the joints, in the order of the joint position vector.
+    const std::vector<std::string>& getJointNames() const;
+
+    // URDF names of the links (excluding the root), in the order returned by
+    // getLinkFrames.
+    const std::vector<std::string>& getLinkNames() const;
+
+    // Per chain buffers for computing the FK of a tree. A model may be shared
+    // by groups whose feedback arrives on different threads, so callers that
+    // compute FK repeatedly keep their own workspace; it is sized on first use.
+    struct FKWorkspace {
+      std::vector<Eigen::VectorXd> chain_positions;
+      std::vector<hebi::robot_model::Matrix4dVector> chain_frames;
+      hebi::robot_model::Matrix4dVector chain_ends;
+    };
+
+    // Computes the frames of every chain in the tree, in depth-first order,
+    // given the joint positions of the whole tree (also in depth-first order).
+    // Each chain's base transform is computed once and shared by all of its
+    // descendants. A branching link's frame is only reported once, before the
+    // frames of its children. "frames" is only resized when its size changes.
+    void getFK(HebiFrameType frame_type, const Eigen::VectorXd& positions,
+      hebi::robot_model::Matrix4dVector& frames) const;
+    void getFK(HebiFrameType frame_type, const Eigen::VectorXd& positions,
+      hebi::robot_model::Matrix4dVector& frames, FKWorkspace& workspace) const;
+
+    // Computes the frame of every link (as defined in the URDF, i.e., the
+    // frame of its parent joint), along with the output frames they are
+    // derived from. Both vectors are only resized when their size changes, so
+    // callers can reuse them across calls.
+    void getLinkFrames(const Eigen::VectorXd& positions,
+      hebi::robot_model::Matrix4dVector& output_frames,
+      hebi::robot_model::Matrix4dVector& link_frames, FKWorkspace& workspace) const;
+
+    // True if any link has collision geometry
+    bool hasCapsules() const;
+
+    // Checks the link capsules against each other at the given link frames
+    // (from getLinkFrames). Links that are rigidly attached to each other, or
+    // connected by a single joint, always touch and are not checked. Returns
+    // true and the (getLinkNames) indices of the first pair found if any
+    // capsules intersect. "points" is a workspace that callers can reuse.
+    bool findSelfCollision(const hebi::robot_model::Matrix4dVector& link_frames,
+      double mesh_radius, std::vector<Eigen::Vector3d>& points,
+      size_t& link_a, size_t& link_b) const;
+
+    // Binary snapshot of the chain element lists; the snapshot is only read if
+    // it was written for a description with the given content hash.
+    static bool readSnapshot(const std::string& file, uint64_t hash,
+      std::vector<Chain>& chains, std::string& base_name);
+    static bool writeSnapshot(const std::string& file, uint64_t hash,
+      const std::vector<Chain>& chains, const std::string& base_name);
 
   private:
     // Name to imported model map; filled in by "load"
     static std::map<std::string, HebirosModel> models;
 
-    // The underlying C++ API model that is "owned" by this HebirosModel
-    std::unique_ptr<hebi::robot_model::RobotModel> model;
-   
-    // Loads any model on the given parameter name into the URDF model 
-    static bool loadURDF(const std::string& description_param, urdf::Model& model);
+    // The underlying C++ API models (one per chain) that are "owned" by this
+    // HebirosModel, in depth-first order; parents always precede children.
+    std::vector<Chain> chains;
+
+    std::string base_name;
+    std::vector<std::string> joint_names;
+    std::vector<std::string> link_names;
+
+    // Index of the first output frame of each chain in the full frame vector
+    std::vector<size_t> output_offsets;
+
+    // All capsules, the link index of each, and the pairs of capsules (by
+    // index) that can collide
+    std::vector<Capsule> capsules;
+    std::vector<size_t> capsule_links;
+    std::vector<std::pair<size_t, size_t>> collision_pairs;
+
+    std::unique_ptr<HebirosReachabilityMap> reachability_map;
+
+    // Closed form IK, for models with a supported layout; otherwise nullptr
+    std::unique_ptr<HebirosAnalyticIK> analytic_ik;
+
+    // Create hebi robot model element lists from the URDF; return true on
+    // success, false on failure.
+    static bool parseURDF(const urdf::Model& model, std::vector<Chain>& chains,
+      std::string& base_name);
+
+    // Creates the hebi robot model for each chain from its element list, and
+    // fills in the joint offsets of each chain.
+    static bool buildChains(std::vector<Chain>& chains);
 
-    // Create a hebi robot model from the URDF; return object on success, empty
-    // pointer on failure.
-    static std::unique_ptr<hebi::robot_model::RobotModel> parseURDF(const urdf::Model& model);
+    // Reads and validates one chain, appending it to "chains"
+    static bool readSnapshotChain(std::istream& in, uint64_t file_size,
+      uint32_t index, std::vector<Chain>& chains);
 };
 
 #endif
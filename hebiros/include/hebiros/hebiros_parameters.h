@@ -3,11 +3,18 @@
 
 #include "ros/ros.h"
 
+#include <map>
+#include <memory>
+
 
 class HebirosParameters {
 
   public:
 
+    // Parameters are loaded from and set on the parameter server through
+    // "n"; without a node handle, as in tools that run without a ROS master,
+    // only the values set in this process and the defaults are used.
+    static void setNodeHandle(std::shared_ptr<ros::NodeHandle> n);
     static void setNodeParameters();
     static void loadBool(std::string name);
     static void setBool(std::string name, bool value);
@@ -15,13 +22,24 @@ class HebirosParameters {
     static void loadInt(std::string name);
     static void setInt(std::string name, int value);
     static int getInt(std::string name);
+    static void loadDouble(std::string name);
+    static void setDouble(std::string name, double value);
+    static double getDouble(std::string name);
+    static void loadString(std::string name);
+    static void setString(std::string name, std::string value);
+    static std::string getString(std::string name);
 
   private:
 
+    static std::shared_ptr<ros::NodeHandle> n_ptr;
     static std::map<std::string, bool> bool_parameters_default;
     static std::map<std::string, bool> bool_parameters;
     static std::map<std::string, int> int_parameters_default;
     static std::map<std::string, int> int_parameters;
+    static std::map<std::string, double> double_parameters_default;
+    static std::map<std::string, double> double_parameters;
+    static std::map<std::string, std::string> string_parameters_default;
+    static std::map<std::string, std::string> string_parameters;
 
 };
 
@@ -3,6 +3,9 @@
 
 #include "ros/ros.h"
 #include "sensor_msgs/JointState.h"
+#include "geometry_msgs/PoseStamped.h"
+#include "geometry_msgs/WrenchStamped.h"
+#include "tf2_msgs/TFMessage.h"
 
 #include "hebiros/FeedbackMsg.h"
 
@@ -14,10 +17,17 @@ class HebirosPublishers {
     static std::map<std::string, ros::Publisher> publishers;
 
     void registerGroupPublishers(std::string group_name);
-    void feedback(hebiros::FeedbackMsg feedback_msg, std::string group_name);
-    void feedbackJointState(sensor_msgs::JointState joint_state_msg, std::string group_name);
-    void feedbackJointStateUrdf(sensor_msgs::JointState joint_state_msg, std::string group_name);
-    void commandJointState(sensor_msgs::JointState joint_state_msg, std::string group_name);
+    void feedback(const hebiros::FeedbackMsg& feedback_msg, std::string group_name);
+    // Publishes the message itself, without copying it for local subscribers
+    void feedback(const boost::shared_ptr<hebiros::FeedbackMsg const>& feedback_msg,
+      std::string group_name);
+    void feedbackJointState(const sensor_msgs::JointState& joint_state_msg,
+      std::string group_name);
+    void feedbackJointStateUrdf(const sensor_msgs::JointState& joint_state_msg,
+      std::string group_name);
+    void feedbackModel(const hebiros::FeedbackMsg& feedback_msg, std::string group_name);
+    void commandJointState(const sensor_msgs::JointState& joint_state_msg,
+      std::string group_name);
 
 };
 
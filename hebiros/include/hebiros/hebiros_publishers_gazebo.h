@@ -5,13 +5,30 @@
 
 #include "hebiros_publishers.h"
 
+#include <mutex>
+
 
 class HebirosPublishersGazebo : public HebirosPublishers {
 
   public:
 
     void registerGroupPublishers(std::string group_name);
-    void command(hebiros::CommandMsg command_msg, std::string group_name);
+    void command(const hebiros::CommandMsg& command_msg, std::string group_name);
+    // Forwards a received command without copying it, unless it is held for
+    // lockstep mode
+    void command(const boost::shared_ptr<hebiros::CommandMsg const>& command_msg,
+      std::string group_name);
+    void publishCommand(const hebiros::CommandMsg& command_msg, std::string group_name);
+    void publishCommand(const boost::shared_ptr<hebiros::CommandMsg const>& command_msg,
+      std::string group_name);
+    void stepCommand(std::string group_name);
+
+  private:
+
+    // In lockstep mode, the latest command of each group; one is sent in reply
+    // to each feedback (see stepCommand)
+    std::mutex lockstep_mutex;
+    std::map<std::string, boost::shared_ptr<hebiros::CommandMsg const>> lockstep_commands;
 
 };
 
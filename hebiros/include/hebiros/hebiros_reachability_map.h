@@ -0,0 +1,69 @@
+#ifndef HEBIROS_REACHABILITY_MAP_H
+#define HEBIROS_REACHABILITY_MAP_H
+
+#include "Eigen/Eigen"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A voxel grid of the end effector positions a model can reach, with the best
+// manipulability found in each voxel. Maps are generated offline by the
+// hebiros_reachability_map tool and memory mapped by the node, so lookups are
+// a single array access.
+class HebirosReachabilityMap {
+
+  public:
+
+    // File layout (native byte order): the header, followed by
+    // size[0] * size[1] * size[2] voxels with x varying fastest.
+    struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t dof_count;
+      double origin[3];
+      double voxel_size;
+      uint32_t size[3];
+      uint32_t reserved;
+      uint64_t sample_count;
+    };
+
+    struct Voxel {
+      // Number of samples with the end effector in this voxel; 0 means the
+      // voxel was never reached.
+      uint32_t count;
+      // Largest sqrt(det(J * J^T)) of these samples, where J is the end
+      // effector Jacobian (only its position rows for fewer than 6 joints)
+      float manipulability;
+    };
+
+    HebirosReachabilityMap();
+    ~HebirosReachabilityMap();
+
+    HebirosReachabilityMap(const HebirosReachabilityMap&) = delete;
+    HebirosReachabilityMap& operator=(const HebirosReachabilityMap&) = delete;
+
+    // Maps the given file read-only; returns false if it cannot be opened or is
+    // not a valid map.
+    bool open(const std::string& file);
+
+    const Header& getHeader() const;
+
+    // Returns the voxel containing the given position (in the model's base
+    // frame), or nullptr if the position is outside of the grid.
+    const Voxel* lookup(const Eigen::Vector3d& position) const;
+
+    // Writes a map; header.magic and header.version are filled in.
+    static bool write(const std::string& file, Header header, const std::vector<Voxel>& voxels);
+
+  private:
+
+    void close();
+
+    void* data;
+    size_t data_size;
+    const Header* header;
+    const Voxel* voxels;
+};
+
+#endif
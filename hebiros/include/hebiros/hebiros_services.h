@@ -9,10 +9,13 @@
 #include "hebiros/AddGroupFromURDFSrv.h"
 #include "hebiros/AddModelFromURDFSrv.h"
 #include "hebiros/ModelFkSrv.h"
+#include "hebiros/ModelReachableSrv.h"
+#include "hebiros/ModelIkSrv.h"
 #include "hebiros/SizeSrv.h"
 #include "hebiros/SetFeedbackFrequencySrv.h"
 #include "hebiros/SetCommandLifetimeSrv.h"
 #include "hebiros/SendCommandWithAcknowledgementSrv.h"
+#include "hebiros/SetModelSrv.h"
 
 #include "hebiros_group.h"
 
@@ -62,12 +65,20 @@ class HebirosServices {
       SendCommandWithAcknowledgementSrv::Request &req, 
       SendCommandWithAcknowledgementSrv::Response &res, std::string group_name);
 
+    bool setModel(
+      SetModelSrv::Request &req, SetModelSrv::Response &res, std::string group_name);
+
     bool split(const std::string &orig, std::string &name, std::string &family);
 
     void addJointChildren(std::set<std::string>& names, std::set<std::string>& families, 
       std::map<std::string, std::string>& full_names, const urdf::Link* link);
 
     bool fk(ModelFkSrv::Request& req, ModelFkSrv::Response& res, const std::string& model_name);
+
+    bool ik(ModelIkSrv::Request& req, ModelIkSrv::Response& res, const std::string& model_name);
+
+    bool reachable(ModelReachableSrv::Request& req, ModelReachableSrv::Response& res,
+      const std::string& model_name);
 };
 
 #endif
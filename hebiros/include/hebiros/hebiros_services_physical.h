@@ -35,6 +35,23 @@ class HebirosServicesPhysical : public HebirosServices {
       AddGroupFromNamesSrv::Request &req, AddGroupFromNamesSrv::Response &res,
       std::map<std::string, std::string> joint_full_names);
 
+    // Looks up the modules of a group, or creates an imitation group; this
+    // may block for the lookup timeout, but touches no node state, so it can
+    // run on any thread
+    std::shared_ptr<hebi::Group> lookupGroup(const AddGroupFromNamesSrv::Request &req);
+
+    // Registers a looked up group with its services, publishers, subscribers
+    // and actions; fails if the lookup did
+    bool registerGroup(
+      AddGroupFromNamesSrv::Request &req, AddGroupFromNamesSrv::Response &res,
+      const std::map<std::string, std::string>& joint_full_names,
+      std::shared_ptr<hebi::Group> group_ptr);
+
+    // Fills the names and families of a group with the joints of a URDF
+    bool namesFromURDF(const std::string& description_param,
+      AddGroupFromNamesSrv::Request &names_req,
+      std::map<std::string, std::string>& joint_full_names);
+
     bool addGroupFromNames(
       AddGroupFromNamesSrv::Request &req, AddGroupFromNamesSrv::Response &res);
 
@@ -0,0 +1,58 @@
+#ifndef HEBIROS_SHM_TRANSPORT_H
+#define HEBIROS_SHM_TRANSPORT_H
+
+#include "ros/ros.h"
+#include "hebiros/CommandMsg.h"
+#include "hebiros/FeedbackMsg.h"
+
+#include "sim/hebiros_shm_ring.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+// Exchanges commands and feedback with the Gazebo plugin through shared memory
+// rings (see hebiros::sim::ShmRing) instead of the hebiros_gazebo_plugin
+// topics, for groups whose plugin runs on the same host. Feedback read from a
+// ring is handed to HebirosSubscribersGazebo::feedback on the node's callback
+// queue, like feedback from the topic; the topics stay subscribed and
+// advertised, and are used whenever a ring cannot be.
+class HebirosShmTransport {
+
+  public:
+
+    ~HebirosShmTransport();
+
+    // Opens the rings the plugin created for a group; returns false if there
+    // are none, and the group keeps using topics
+    bool attach(std::string group_name);
+
+    // Writes a command to the group's ring; returns false if it has to be
+    // published instead. Once a command of a group has been published, so are
+    // all later ones, so that none overtakes another.
+    bool sendCommand(const hebiros::CommandMsg& command_msg, std::string group_name);
+
+    void stop();
+
+  private:
+
+    struct Rings {
+      std::unique_ptr<hebiros::sim::ShmRing> command;
+      std::unique_ptr<hebiros::sim::ShmRing> feedback;
+      bool command_fallback = false;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, Rings> groups;
+    std::atomic<bool> running {false};
+    std::thread thread;
+
+    // Polls the feedback rings of all groups until stopped
+    void receive();
+
+};
+
+#endif
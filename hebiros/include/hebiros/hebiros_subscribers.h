@@ -2,6 +2,10 @@
 #define HEBIROS_SUBSCRIBERS_H
 
 #include "ros/ros.h"
+#include "sensor_msgs/JointState.h"
+#include "geometry_msgs/Twist.h"
+#include "hebiros/CommandMsg.h"
+#include "hebiros/SettingsMsg.h"
 
 
 class HebirosSubscribers {
@@ -11,8 +15,23 @@ class HebirosSubscribers {
     static std::map<std::string, ros::Subscriber> subscribers;
 
     virtual void registerGroupSubscribers(std::string group_name) {}
+    virtual void sendJointCommand(const sensor_msgs::JointState& data,
+      std::string group_name) {}
+    void twistCommand(const boost::shared_ptr<geometry_msgs::Twist const> data,
+      std::string group_name);
+    void sendTwistCommands();
     static bool jointFound(std::string group_name, std::string joint_name);
     static void jointNotFound(std::string joint_name);
+    static bool holdCommand(std::string group_name, const sensor_msgs::JointState& data,
+      const hebiros::SettingsMsg* settings_data);
+    // Same for a command message; it is only converted for groups with a model
+    static bool holdCommand(std::string group_name, const hebiros::CommandMsg& data);
+
+  private:
+
+    // Twist command of the group being sent, copied out of its model under
+    // the model lock; reused across groups and calls
+    sensor_msgs::JointState twist_joint_data;
 
 };
 
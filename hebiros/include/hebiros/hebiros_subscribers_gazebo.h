@@ -17,9 +17,16 @@ class HebirosSubscribersGazebo : public HebirosSubscribers {
       std::string group_name);
     void jointCommand(const boost::shared_ptr<sensor_msgs::JointState const> data,
       std::string group_name);
+    void sendJointCommand(const sensor_msgs::JointState& data, std::string group_name);
     void feedback(const boost::shared_ptr<hebiros::FeedbackMsg const> data,
       std::string group_name);
 
+  private:
+
+    // Joint commands converted for the simulator; reused for every command,
+    // which is only sent from the node's callback thread
+    hebiros::CommandMsg joint_command_msg;
+
 };
 
 #endif
@@ -19,6 +19,7 @@ class HebirosSubscribersPhysical : public HebirosSubscribers {
       std::string group_name);
     void jointCommand(const boost::shared_ptr<sensor_msgs::JointState const> data,
       std::string group_name);
+    void sendJointCommand(const sensor_msgs::JointState& data, std::string group_name);
     void feedback(std::string group_name, const hebi::GroupFeedback& group_fbk);
     static void addJointCommand(hebi::GroupCommand* group_command,
       sensor_msgs::JointState data, std::string group_name);
@@ -0,0 +1,46 @@
+#ifndef HEBIROS_URDF_CACHE_H
+#define HEBIROS_URDF_CACHE_H
+
+#include "ros/ros.h"
+#include "urdf/model.h"
+
+#include <mutex>
+
+
+// Cache of parsed URDF descriptions, shared by all services that read URDFs
+// from the parameter server. Entries are keyed by parameter name and content
+// hash, so a description is only re-parsed when the parameter changes. The
+// cache may be used from several threads.
+class HebirosURDFCache {
+
+  public:
+
+    // Reads the description parameter and computes its content hash, without
+    // parsing it. Returns false if the parameter could not be read.
+    static bool getDescription(const std::string& description_param,
+      std::string& description, uint64_t& hash);
+
+    // Returns the parsed URDF on the given parameter, or nullptr on failure.
+    static std::shared_ptr<const urdf::Model> get(const std::string& description_param);
+
+    // As above, but for a description that has already been read.
+    static std::shared_ptr<const urdf::Model> get(const std::string& description_param,
+      const std::string& description, uint64_t hash);
+
+    // Content hash (64 bit FNV-1a); this is stable across runs and platforms,
+    // so it can be used to validate data stored on disk.
+    static uint64_t hash(const std::string& content);
+
+  private:
+
+    struct Entry {
+      uint64_t hash;
+      std::shared_ptr<const urdf::Model> model;
+    };
+
+    static std::mutex mutex;
+    static std::map<std::string, Entry> entries;
+
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef HEBIROS_WORKER_POOL_H
+#define HEBIROS_WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Runs jobs that would block the node's callback thread, such as module
+// lookups, on a fixed set of threads. Jobs run in the order they are posted,
+// as many at a time as there are threads; they must not use the node's
+// registries, but hand their results back on its callback queue.
+class HebirosWorkerPool {
+
+  public:
+
+    ~HebirosWorkerPool();
+
+    // Starts the threads; jobs posted before this wait until then
+    void start(size_t thread_count);
+
+    void post(std::function<void()> job);
+
+    // Waits for the jobs that are running, and drops those not yet started
+    void stop();
+
+  private:
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::thread> threads;
+    bool running = false;
+
+    void work();
+
+};
+
+#endif
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <vector>
+
+#include "ros/ros.h"
+#include "hebiros/CommandMsg.h"
+#include "hebiros/SettingsMsg.h"
+#include "hebiros_temperature_model.h"
+#include "hebiros_triple_buffer.h"
+
+namespace hebiros {
+namespace sim {
+
+// Computes the output force of every actuator in a group in one pass, from
+// the module's control strategies, a PWM to force motor model, and the
+// temperature model and safety limit. Targets, gains, PID state and
+// temperature state are stored as one contiguous array per quantity, indexed
+// by the joint's feedback index; targets and gains are gathered from the
+// command and settings messages when those change, not on every step.
+//
+// This does not depend on a physics engine: the caller sets the measured
+// joint state before each update and applies the resulting forces. The
+// Gazebo plugin and the node's headless simulator both use it.
+//
+// Commands may be set from another thread than the one running updates. They
+// are handed over through a triple buffer, so an update always sees a
+// complete command and never waits for the thread that sets it.
+class ActuatorController {
+
+public:
+
+  // Targets, control strategies and gains of each joint, as gathered from a
+  // command; joints without a target track their measured state
+  struct Command {
+    std::vector<double> position_target;
+    std::vector<double> velocity_target;
+    std::vector<double> effort_target;
+    std::vector<char> has_position_target;
+    std::vector<char> has_velocity_target;
+    std::vector<char> has_effort_target;
+
+    std::vector<int> control_strategy;
+    std::vector<double> position_kp;
+    std::vector<double> position_ki;
+    std::vector<double> position_kd;
+    std::vector<double> velocity_kp;
+    std::vector<double> velocity_ki;
+    std::vector<double> velocity_kd;
+    std::vector<double> effort_kp;
+    std::vector<double> effort_ki;
+    std::vector<double> effort_kd;
+
+    // When the command was received
+    ros::Time time;
+  };
+
+  // Measured joint state, set by the caller before each update
+  std::vector<double> position;
+  std::vector<double> velocity;
+  std::vector<double> effort;
+
+  // Output force of each joint, computed by update
+  std::vector<double> force;
+
+  // Modeled temperatures of each joint
+  std::vector<double> winding_temperature;
+  std::vector<double> housing_temperature;
+  std::vector<double> body_temperature;
+
+  // Number of updates in which the temperature safety limit reduced the PWM
+  // of each joint
+  std::vector<uint64_t> safety_limit_count;
+
+  ActuatorController() = default;
+
+  size_t size() const;
+
+  // Appends a joint; its feedback index is the previous size. Joints have to
+  // be added before another thread starts setting commands.
+  void addJoint(double gear_ratio, bool is_x8, const TemperatureModel& temperature);
+
+  // Gather targets, and control strategies and gains, for each joint from the
+  // entries at its command index, and publish them to the updating thread
+  void setCommand(const hebiros::CommandMsg& command, const hebiros::SettingsMsg& settings,
+    const std::vector<int>& command_indices, const ros::Time& time);
+
+  // Switch to the latest command set, if there is a new one; returns true if
+  // the command changed
+  bool acquireCommand();
+  bool hasCommand() const;
+  const Command& getCommand() const;
+
+  // Compute the force of all joints, and advance their PID and temperature
+  // state, over an iteration of dt seconds
+  void update(double dt);
+
+private:
+
+  TripleBuffer<Command> commands;
+  bool command_acquired = false;
+
+  std::vector<double> position_prev_error;
+  std::vector<double> position_elapsed_error;
+  std::vector<double> velocity_prev_error;
+  std::vector<double> velocity_elapsed_error;
+  std::vector<double> effort_prev_error;
+  std::vector<double> effort_elapsed_error;
+
+  // Motor parameters
+  std::vector<double> gear_ratio;
+  std::vector<float> speed_constant;
+  std::vector<float> term_resist;
+
+  // Distinct thermal parameters among the joints, each with its exact
+  // discretization over the last dt (see TemperatureModel::Step), and the
+  // index into these of each joint
+  std::vector<TemperatureModel::Parameters> thermal_parameters;
+  std::vector<TemperatureModel::Step> thermal_steps;
+  std::vector<size_t> thermal_model;
+
+  // Power into each motor's winding over the current update
+  std::vector<double> power_in;
+
+  // PWM limit from the temperature safety controller
+  std::vector<double> max_pwm;
+
+};
+
+}
+}
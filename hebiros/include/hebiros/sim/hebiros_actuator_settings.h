@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "hebiros/SettingsMsg.h"
+
+namespace hebiros {
+namespace sim {
+
+// Default settings and motor parameters of simulated actuators, by model name
+// ("X5_1", "X8_9", ...). Unknown model names get the parameters of an X5-1.
+//
+// The default gains of each model are read once from the gains files of the
+// hebiros package (gains/<model>_strategy<n>.xml), in the format of
+// GroupCommand::readGains/writeGains, so that they match the gains flashed to
+// the actuators; models without a file keep built-in gains.
+class ActuatorSettings {
+public:
+  // Gains of one controller: kp, ki, kd
+  typedef std::array<double, 3> PidGains;
+
+  struct Gains {
+    PidGains position;
+    PidGains velocity;
+    PidGains effort;
+  };
+
+  // Default gains of a model, by control strategy
+  typedef std::array<Gains, 5> GainsTable;
+
+  static double getGearRatio(const std::string& model_name);
+  static bool isX8(const std::string& model_name);
+
+  // The table stays valid for the lifetime of the program
+  static const GainsTable& getDefaultGains(const std::string& model_name);
+
+  // Reads the control strategy and the gains of the first module from a gains
+  // file; gains missing from the file are left as they are
+  static bool readGainsFile(const std::string& file_name, int& control_strategy,
+    Gains& gains);
+
+  // Reads the gains of a control strategy from a gains file. Gains are left as
+  // they are (the built-in gains) if the file is for another control
+  // strategy; returns false if there is no gains file.
+  static bool readStrategyGains(const std::string& file_name, int control_strategy,
+    Gains& gains);
+
+  // Appends a joint to the settings, with the default control strategy and
+  // its default gains
+  static void addDefaults(const std::string& name, const GainsTable& defaults,
+    hebiros::SettingsMsg& settings);
+
+  // Overwrites the settings of joint i with any settings given for it in
+  // "changes". A new control strategy first brings in its default gains, as
+  // it does on the actuators.
+  static void change(const hebiros::SettingsMsg& changes, int i,
+    const GainsTable& defaults, hebiros::SettingsMsg& settings);
+};
+
+}
+}
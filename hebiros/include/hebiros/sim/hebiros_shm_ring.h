@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ros/serialization.h"
+
+namespace hebiros {
+namespace sim {
+
+// A ring of ROS messages in POSIX shared memory, from one writer process to
+// one reader process on the same host. Messages are stored serialized in
+// fixed-size slots; writing and reading never block and take no locks, so the
+// Gazebo plugin and the node can exchange commands and feedback without going
+// through TCPROS.
+//
+// The owner creates the ring and removes it when destroyed; the other side
+// opens it by name. The reader marks itself attached, so that the writer only
+// uses the ring while someone reads it. A write fails if the message does not
+// fit in a slot or the ring is full (the reader stopped reading); the caller
+// is expected to fall back to a ROS topic then.
+class ShmRing {
+
+public:
+
+  ~ShmRing();
+
+  //Shared memory name for the ring that replaces a topic; "topic" is the
+  //fully resolved name, so that both sides agree on it
+  static std::string nameForTopic(const std::string& topic);
+
+  //Create the ring, or reset it if it exists; returns nullptr on failure
+  static std::unique_ptr<ShmRing> create(const std::string& name,
+    uint32_t slot_count, uint32_t slot_size);
+
+  //Open a ring created by another process; returns nullptr if there is none
+  static std::unique_ptr<ShmRing> open(const std::string& name);
+
+  //Mark the reader as attached, dropping anything written before; or as gone
+  void attachReader(bool attached);
+  bool hasReader() const;
+
+  //Serialize a message into the next free slot; returns false if it does not
+  //fit or the ring is full
+  template <typename M>
+  bool write(const M& message) {
+    uint32_t length = ros::serialization::serializationLength(message);
+    uint8_t* slot = beginWrite(length);
+    if (!slot) {
+      return false;
+    }
+    ros::serialization::OStream stream(slot, length);
+    ros::serialization::serialize(stream, message);
+    endWrite(length);
+    return true;
+  }
+
+  //Deserialize the oldest message into "message"; returns false if the ring
+  //is empty, or if the message runs past the end of its slot (the slot is
+  //dropped, and "message" may be partly overwritten)
+  template <typename M>
+  bool read(M& message) {
+    uint32_t length;
+    uint8_t* slot = beginRead(length);
+    if (!slot) {
+      return false;
+    }
+    ros::serialization::IStream stream(slot, length);
+    bool complete = true;
+    try {
+      ros::serialization::deserialize(stream, message);
+    }
+    catch (const ros::serialization::StreamOverrunException&) {
+      complete = false;
+    }
+    endRead();
+    return complete;
+  }
+
+private:
+
+  // Shared layout: this header, then slot_count slots of slot_size bytes,
+  // each starting with the length of its message. "head" and "tail" count
+  // the messages written and read so far; only the writer stores head, and
+  // only the reader stores tail.
+  struct Header {
+    std::atomic<uint32_t> magic;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    std::atomic<uint32_t> reader_attached;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+  };
+
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+    "shared memory rings need lock-free 64-bit atomics");
+
+  ShmRing(const std::string& name, void* memory, size_t size, bool owner);
+
+  uint8_t* slot(uint64_t index);
+  uint8_t* beginWrite(uint32_t length);
+  void endWrite(uint32_t length);
+  uint8_t* beginRead(uint32_t& length);
+  void endRead();
+
+  std::string name;
+  void* memory;
+  size_t size;
+  bool owner;
+  Header* header;
+
+};
+
+}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+
+namespace hebiros {
+namespace sim {
+
+// A simple multi-stage actuator temperature model.
+class TemperatureModel {
+public:
+  struct Parameters {
+    // Thermal resistances: winding-housing, housing-body, body-environment
+    double r_wh;
+    double r_hb;
+    double r_be;
+
+    // Thermal capacitances: winding, housing, body
+    double c_w;
+    double c_h;
+    double c_b;
+  };
+
+  // The model discretized exactly over a step of dt seconds, with the input
+  // power held over the step. For temperatures relative to the environment,
+  // x = (t_w, t_h, t_b) - t_e:
+  //   x(t + dt) = phi x(t) + gamma power_in
+  // This is stable for any dt, unlike an explicit Euler step, which diverges
+  // once dt exceeds the winding's time constant (a few hundred ms).
+  struct Step {
+    double dt;
+    double phi[3][3];
+    double gamma[3];
+  };
+
+  static TemperatureModel createX5();
+  static TemperatureModel createX8();
+
+  // Compute the matrix exponential of the model over dt
+  static Step discretize(const Parameters& params, double dt);
+
+  // Advance the temperatures of n actuators with the same parameters by one
+  // step, each with its own input power
+  static void update(const Step& step, size_t n, const double* power_in,
+    double* t_w, double* t_h, double* t_b);
+
+  // Advance this model by dt; the step is recomputed only when dt changes
+  void update(double power_in, double dt);
+
+  // Winding temperature
+  double getMotorWindingTemperature() const { return t_w_; }
+  double getMotorHousingTemperature() const { return t_h_; }
+  double getActuatorBodyTemperature() const { return t_b_; }
+
+  const Parameters& getParameters() const { return params_; }
+
+  // Environment temperature (in *C) ; assume room temperature + fudge factor
+  static constexpr double t_e_{32.0};
+
+private:
+  TemperatureModel(
+    double r_wh, double r_hb, double r_be,
+    double c_w, double c_h, double c_b);
+
+  const Parameters params_;
+
+  // Last step used by update
+  Step step_;
+
+  // State variables - these are the bodies for which we
+  // model temperature
+  double t_w_{34.0}; // Motor winding
+  double t_h_{34.0}; // Motor housing
+  double t_b_{32.0}; // Actuator body
+};
+
+}
+}
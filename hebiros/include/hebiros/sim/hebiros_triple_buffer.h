@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace hebiros {
+namespace sim {
+
+// Hands the latest value from one writer thread to one reader thread without
+// locks. The writer fills its back buffer and swaps it with the middle buffer;
+// the reader swaps its front buffer with the middle buffer if something new
+// was published since it last looked. Neither side waits for the other, and
+// values are never copied between buffers, so the writer has to fill the
+// whole back buffer before each publish.
+template <typename T>
+class TripleBuffer {
+
+public:
+
+  TripleBuffer() = default;
+
+  //Buffer the writer fills before publishing
+  T& back() {
+    return this->buffers[this->back_];
+  }
+
+  //Make the back buffer the latest value
+  void publish() {
+    this->back_ = this->middle.exchange(this->back_ | FRESH, std::memory_order_acq_rel) & INDEX;
+  }
+
+  //Take the latest value if it is newer than the front buffer
+  bool acquire() {
+    if (!(this->middle.load(std::memory_order_relaxed) & FRESH)) {
+      return false;
+    }
+    this->front_ = this->middle.exchange(this->front_, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+
+  //Buffer the reader uses, as of the last acquire
+  const T& front() const {
+    return this->buffers[this->front_];
+  }
+
+  //All three buffers, to set them up before the reader starts
+  T& operator[](size_t index) {
+    return this->buffers[index];
+  }
+
+private:
+
+  static constexpr uint8_t INDEX = 0x3;
+  static constexpr uint8_t FRESH = 0x4;
+
+  T buffers[3];
+  uint8_t back_ = 0;
+  uint8_t front_ = 1;
+  std::atomic<uint8_t> middle {2};
+
+};
+
+}
+}
@@ -11,6 +11,10 @@ public:
   void update(double measured_temp);
   double limit(double raw_value);
 
+  // The PWM limit for a measured temperature; update() applies this to the
+  // controller's own limit, and batched controllers can apply it directly.
+  static double computeMaxPwm(double max_temp, double lambda, double measured_temp);
+
 private:
   double max_temp_;
   double lambda_{1};
@@ -1,5 +1,10 @@
 #include "hebiros.h"
 
+#include "ros/callback_queue.h"
+#include "rosgraph_msgs/Clock.h"
+
+#include "hebiros_group_registry.h"
+
 
 std::shared_ptr<ros::NodeHandle> HebirosNode::n_ptr;
 HebirosPublishersGazebo HebirosNode::publishers_gazebo;
@@ -9,13 +14,17 @@ HebirosSubscribersPhysical HebirosNode::subscribers_physical;
 HebirosServicesGazebo HebirosNode::services_gazebo;
 HebirosServicesPhysical HebirosNode::services_physical;
 HebirosClients HebirosNode::clients;
+HebirosShmTransport HebirosNode::shm_transport;
 HebirosActions HebirosNode::actions;
+bool HebirosNode::use_sim = false;
+bool HebirosNode::use_imitation = false;
 
 //Initialize the hebiros_node and advertise base level topics and services
 //Loop in place allowing callback functions to be run
 HebirosNode::HebirosNode (int argc, char **argv) {
 
   HebirosNode::n_ptr = std::make_shared<ros::NodeHandle>(n);
+  HebirosParameters::setNodeHandle(HebirosNode::n_ptr);
 
   use_gazebo = false;
 
@@ -26,12 +35,27 @@ HebirosNode::HebirosNode (int argc, char **argv) {
         ROS_INFO("Using Gazebo");
       }
     }
+    if (argv[i-1] == std::string("-use_sim")) {
+      if (argv[i] == std::string("true")) {
+        use_gazebo = true;
+        use_sim = true;
+        ROS_INFO("Using the built-in simulator");
+      }
+    }
+    if (argv[i-1] == std::string("-use_imitation")) {
+      if (argv[i] == std::string("true")) {
+        use_imitation = true;
+        ROS_INFO("Using imitation groups");
+      }
+    }
   }
 
   if (use_gazebo) {
     HebirosParameters::setBool("use_sim_time", true);
     services_gazebo.registerNodeServices();
-    clients.registerNodeClients();
+    if (!use_sim) {
+      clients.registerNodeClients();
+    }
   }
   else {
     HebirosParameters::setBool("use_sim_time", false);
@@ -40,21 +64,103 @@ HebirosNode::HebirosNode (int argc, char **argv) {
 
   HebirosParameters::setNodeParameters();
 
+  if (!use_gazebo) {
+    actions.registerNodeActions();
+  }
+
   loop();
 }
 
 void HebirosNode::cleanup() {
+  shm_transport.stop();
+  actions.stop();
 }
 
 void HebirosNode::loop() {
+  if (use_sim) {
+    simulate();
+    cleanup();
+    return;
+  }
+
   ros::Rate loop_rate(HebirosParameters::getInt("hebiros/node_frequency"));
 
+  // In lockstep mode, simulated time only advances once feedback has been
+  // answered, so sleeping on it would stall the simulation; handle callbacks
+  // as soon as they arrive instead.
+  bool lockstep = use_gazebo && HebirosParameters::getBool("hebiros/lockstep");
+  ros::WallDuration lockstep_period(1.0/HebirosParameters::getInt("hebiros/node_frequency"));
+
   while(ros::ok()) {
+    if (lockstep) {
+      ros::getGlobalCallbackQueue()->callAvailable(lockstep_period);
+      subscribers_gazebo.sendTwistCommands();
+      continue;
+    }
+
     ros::spinOnce();
+    if (use_gazebo) {
+      subscribers_gazebo.sendTwistCommands();
+    }
+    else {
+      subscribers_physical.sendTwistCommands();
+    }
     loop_rate.sleep();
   }
 
   cleanup();
 }
 
+void HebirosNode::simulate() {
+  double time_step = HebirosParameters::getDouble("hebiros/sim_time_step");
+  double real_time_factor = HebirosParameters::getDouble("hebiros/sim_real_time_factor");
+  double twist_period = 1.0/HebirosParameters::getInt("hebiros/node_frequency");
+
+  ros::Publisher clock_pub = n.advertise<rosgraph_msgs::Clock>("/clock", 10);
+  rosgraph_msgs::Clock clock_msg;
+  ros::Time sim_time;
+  ros::Time next_twist_time;
+  ros::WallTime next_wall_time = ros::WallTime::now();
+  bool has_groups = false;
+  ros::Time::setNow(sim_time);
+
+  while(ros::ok()) {
+    ros::getGlobalCallbackQueue()->callAvailable(
+      has_groups ? ros::WallDuration() : ros::WallDuration(twist_period));
+
+    // Simulated time only advances while there is something to simulate
+    has_groups = false;
+    HebirosGroupRegistry::Instance().forEachGroup(
+      [&](const std::string& group_name, HebirosGroup& group) {
+        has_groups = has_groups || dynamic_cast<HebirosGroupSim*>(&group);
+      });
+    if (!has_groups) {
+      next_wall_time = ros::WallTime::now();
+      continue;
+    }
 
+    sim_time += ros::Duration(time_step);
+    ros::Time::setNow(sim_time);
+    clock_msg.clock = sim_time;
+    clock_pub.publish(clock_msg);
+
+    HebirosGroupRegistry::Instance().forEachGroup(
+      [&](const std::string& group_name, HebirosGroup& group) {
+        HebirosGroupSim* sim_group = dynamic_cast<HebirosGroupSim*>(&group);
+        if (sim_group && sim_group->step(time_step, sim_time)) {
+          subscribers_gazebo.feedback(
+            boost::make_shared<FeedbackMsg>(sim_group->getFeedback()), group_name);
+        }
+      });
+
+    if (sim_time >= next_twist_time) {
+      subscribers_gazebo.sendTwistCommands();
+      next_twist_time = sim_time + ros::Duration(twist_period);
+    }
+
+    if (real_time_factor > 0) {
+      next_wall_time += ros::WallDuration(time_step/real_time_factor);
+      ros::WallTime::sleepUntil(next_wall_time);
+    }
+  }
+}
@@ -1,5 +1,7 @@
 #include "hebiros_actions.h"
 
+#include "ros/callback_queue.h"
+
 #include "hebiros.h"
 
 #include "hebiros_group_registry.h"
@@ -10,6 +12,130 @@ std::map<std::string,
   std::shared_ptr<actionlib::SimpleActionServer<hebiros::TrajectoryAction>>>
   HebirosActions::trajectory_actions;
 
+// Runs a function on the node's callback queue, where the group registry and
+// the node's publishers and services may be used
+class QueuedCallback : public ros::CallbackInterface {
+
+  public:
+
+    QueuedCallback(boost::function<void()> function) : function(function) {}
+
+    CallResult call() override {
+      function();
+      return Success;
+    }
+
+  private:
+
+    boost::function<void()> function;
+};
+
+void HebirosActions::registerNodeActions() {
+
+  lookup_pool.start(std::max(1, HebirosParameters::getInt("hebiros/group_lookup_threads")));
+
+  add_group_action = std::make_shared<actionlib::ActionServer<AddGroupAction>>(
+    *HebirosNode::n_ptr, "hebiros/add_group",
+    boost::bind(&HebirosActions::addGroup, this, _1), false);
+
+  add_group_action->start();
+}
+
+//Stop looking up groups, and abort the goals whose lookups will not finish
+void HebirosActions::stop() {
+  lookup_pool.stop();
+
+  for (auto& pending_group : pending_groups) {
+    pending_group.second.setAborted(AddGroupResult(), "Node shutting down");
+  }
+  pending_groups.clear();
+}
+
+void HebirosActions::addGroup(actionlib::ServerGoalHandle<AddGroupAction> goal) {
+
+  AddGroupGoalConstPtr goal_msg = goal.getGoal();
+  AddGroupFromNamesSrv::Request req;
+  std::map<std::string, std::string> joint_full_names;
+  req.group_name = goal_msg->group_name;
+  req.names = goal_msg->names;
+  req.families = goal_msg->families;
+
+  if (req.names.empty()) {
+    std::string description_param = goal_msg->description_param.empty() ?
+      "robot_description" : goal_msg->description_param;
+    if (!HebirosNode::services_physical.namesFromURDF(
+      description_param, req, joint_full_names)) {
+      goal.setRejected(AddGroupResult(), "Could not load " + description_param);
+      return;
+    }
+  }
+
+  if (HebirosGroupRegistry::Instance().hasGroup(req.group_name) ||
+    pending_groups.count(req.group_name) > 0) {
+    ROS_WARN("Group [%s] already exists", req.group_name.c_str());
+    goal.setRejected(AddGroupResult(), "Group already exists");
+    return;
+  }
+
+  if (req.families.size() != 1 && req.families.size() != req.names.size()) {
+    ROS_WARN("Invalid number of familes for group [%s]", req.group_name.c_str());
+    goal.setRejected(AddGroupResult(), "Invalid number of families");
+    return;
+  }
+
+  goal.setAccepted();
+  AddGroupFeedback feedback;
+  feedback.state = "looking_up";
+  goal.publishFeedback(feedback);
+  pending_groups[req.group_name] = goal;
+  ROS_INFO("Looking up group [%s]", req.group_name.c_str());
+
+  lookup_pool.post([this, goal, req, joint_full_names]() {
+    std::shared_ptr<hebi::Group> group_ptr = HebirosNode::services_physical.lookupGroup(req);
+    ros::getGlobalCallbackQueue()->addCallback(boost::make_shared<QueuedCallback>(
+      boost::bind(&HebirosActions::finishAddGroup, this, goal, req, joint_full_names, group_ptr)));
+  });
+}
+
+void HebirosActions::finishAddGroup(actionlib::ServerGoalHandle<AddGroupAction> goal,
+  AddGroupFromNamesSrv::Request req, std::map<std::string, std::string> joint_full_names,
+  std::shared_ptr<hebi::Group> group_ptr) {
+
+  // Goals are aborted when the node stops, even if their lookup has finished
+  if (pending_groups.erase(req.group_name) == 0) {
+    return;
+  }
+
+  if (goal.getGoalStatus().status == actionlib_msgs::GoalStatus::PREEMPTING) {
+    ROS_INFO("Canceled adding group [%s]", req.group_name.c_str());
+    goal.setCanceled();
+    return;
+  }
+
+  AddGroupFeedback feedback;
+  feedback.state = "registering";
+  goal.publishFeedback(feedback);
+
+  if (!group_ptr) {
+    ROS_WARN("Lookup of group [%s] failed", req.group_name.c_str());
+    goal.setAborted(AddGroupResult(), "Lookup failed");
+    return;
+  }
+
+  AddGroupFromNamesSrv::Response res;
+  if (!HebirosNode::services_physical.registerGroup(req, res, joint_full_names, group_ptr)) {
+    // The group can be added through the services while it is looked up
+    goal.setAborted(AddGroupResult(),
+      HebirosGroupRegistry::Instance().hasGroup(req.group_name) ?
+      "Group already exists" : "Registration failed");
+    return;
+  }
+
+  AddGroupResult result;
+  result.size = HebirosGroupRegistry::Instance().getGroup(req.group_name)->size;
+  goal.setSucceeded(result);
+}
+
 void HebirosActions::registerGroupActions(std::string group_name) {
 
   trajectory_actions[group_name] = std::make_shared<
@@ -66,6 +192,19 @@ void HebirosActions::trajectory(const TrajectoryGoalConstPtr& goal, std::string
 
   auto trajectory = trajectory::Trajectory::createUnconstrainedQp(
     time, positions, &velocities, &accelerations);
+
+  // Reject trajectories that would make the group's model collide with itself
+  {
+    std::lock_guard<std::mutex> lock(group->model_mutex);
+    std::string collision;
+    if (group->model && !group->model->checkTrajectory(*trajectory,
+      HebirosParameters::getDouble("hebiros/collision_resolution"),
+      HebirosParameters::getDouble("hebiros/collision_mesh_radius"), collision)) {
+      ROS_WARN("Group [%s]: Rejected trajectory; %s", group_name.c_str(), collision.c_str());
+      action_server->setAborted(TrajectoryResult(), "Self-collision: " + collision);
+      return;
+    }
+  }
   Eigen::VectorXd position_command(num_joints);
   Eigen::VectorXd velocity_command(num_joints);
 
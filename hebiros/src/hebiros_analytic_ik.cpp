@@ -0,0 +1,259 @@
+#include "hebiros_analytic_ik.h"
+
+#include "hebiros_model.h"
+
+#include <cmath>
+
+// Largest offset between wrist axes, or deviation from parallel/perpendicular
+// axes, that still counts as the supported layout. URDFs round their
+// transforms, so these cannot be exact.
+static constexpr double layout_tolerance = 1e-4;
+
+// Largest end effector error of a solution, in meters and (roughly) radians
+static constexpr double solution_tolerance = 1e-5;
+
+// Angle that rotates p to q about the unit axis (Paden-Kahan subproblem 1);
+// only the components of p and q perpendicular to the axis are used.
+static double rotationAngle(const Eigen::Vector3d& axis, const Eigen::Vector3d& p,
+  const Eigen::Vector3d& q) {
+
+  Eigen::Vector3d p_perpendicular = p - axis * axis.dot(p);
+  Eigen::Vector3d q_perpendicular = q - axis * axis.dot(q);
+  return std::atan2(axis.dot(p_perpendicular.cross(q_perpendicular)),
+    p_perpendicular.dot(q_perpendicular));
+}
+
+static double angle(const Eigen::Vector2d& vector) {
+  return std::atan2(vector.y(), vector.x());
+}
+
+static double clamp(double value, double min, double max) {
+  return std::min(std::max(value, min), max);
+}
+
+std::unique_ptr<HebirosAnalyticIK> HebirosAnalyticIK::create(const HebirosModel& model) {
+
+  size_t dof_count = model.getDoFCount();
+  if (!model.isChain() || (dof_count != 5 && dof_count != 6))
+    return nullptr;
+
+  std::unique_ptr<HebirosAnalyticIK> ik(new HebirosAnalyticIK());
+  ik->dof_count = dof_count;
+
+  // At zero positions, a joint's output frame is its input frame; its axis is
+  // the column of that frame given by the joint type.
+  const HebirosModel::Chain& chain = model.getChains()[0];
+  Eigen::VectorXd zeros = Eigen::VectorXd::Zero(dof_count);
+  hebi::robot_model::Matrix4dVector frames;
+  chain.model->getFK(HebiFrameTypeOutput, zeros, frames);
+  for (size_t i = 0; i < chain.elements.size(); ++i) {
+    if (chain.elements[i].type != HebirosModel::Element::Type::Joint)
+      continue;
+    int axis;
+    if (chain.elements[i].joint_type == HebiJointTypeRotationX)
+      axis = 0;
+    else if (chain.elements[i].joint_type == HebiJointTypeRotationY)
+      axis = 1;
+    else if (chain.elements[i].joint_type == HebiJointTypeRotationZ)
+      axis = 2;
+    else
+      return nullptr;
+    ik->axes.push_back(frames[i].block<3,1>(0, axis).normalized());
+    ik->points.push_back(frames[i].topRightCorner<3,1>());
+  }
+  chain.model->getEndEffector(zeros, ik->end_effector);
+
+  // Base not parallel to the shoulder, and elbow parallel to the shoulder
+  const Eigen::Vector3d& shoulder_axis = ik->axes[1];
+  if (ik->axes[0].cross(shoulder_axis).norm() < layout_tolerance ||
+    ik->axes[2].cross(shoulder_axis).norm() > layout_tolerance) {
+    return nullptr;
+  }
+  ik->elbow_direction = ik->axes[2].dot(shoulder_axis) > 0 ? 1 : -1;
+
+  // The wrist center is the point closest to all wrist axes (in the least
+  // squares sense), which has to lie on all of them.
+  Eigen::Matrix3d normal = Eigen::Matrix3d::Zero();
+  Eigen::Vector3d rhs = Eigen::Vector3d::Zero();
+  for (size_t i = 3; i < dof_count; ++i) {
+    if (i + 1 < dof_count && ik->axes[i].cross(ik->axes[i + 1]).norm() < layout_tolerance)
+      return nullptr;
+    Eigen::Matrix3d projection =
+      Eigen::Matrix3d::Identity() - ik->axes[i] * ik->axes[i].transpose();
+    normal += projection;
+    rhs += projection * ik->points[i];
+  }
+  ik->wrist_center = normal.ldlt().solve(rhs);
+  for (size_t i = 3; i < dof_count; ++i) {
+    Eigen::Vector3d offset = ik->wrist_center - ik->points[i];
+    if ((offset - ik->axes[i] * ik->axes[i].dot(offset)).norm() > layout_tolerance)
+      return nullptr;
+  }
+
+  // The shoulder and elbow move the wrist center within a plane perpendicular
+  // to their axes.
+  ik->plane_x = shoulder_axis.unitOrthogonal();
+  ik->plane_y = shoulder_axis.cross(ik->plane_x);
+  auto project = [&ik](const Eigen::Vector3d& point) {
+    return Eigen::Vector2d(point.dot(ik->plane_x), point.dot(ik->plane_y));
+  };
+  ik->shoulder = project(ik->points[1]);
+  ik->elbow = project(ik->points[2]);
+  ik->wrist = project(ik->wrist_center);
+  if ((ik->elbow - ik->shoulder).norm() < layout_tolerance ||
+    (ik->wrist - ik->elbow).norm() < layout_tolerance) {
+    return nullptr;
+  }
+
+  return ik;
+}
+
+bool HebirosAnalyticIK::solve(const Eigen::Matrix4d& target,
+  std::vector<Eigen::VectorXd>& solutions) const {
+
+  solutions.clear();
+  Eigen::Matrix3d target_rotation = target.topLeftCorner<3,3>();
+  Eigen::Matrix3d zero_rotation = end_effector.topLeftCorner<3,3>();
+  Eigen::Vector3d wrist_target = target.topRightCorner<3,1>() + target_rotation *
+    zero_rotation.transpose() * (wrist_center - end_effector.topRightCorner<3,1>());
+
+  // Base: the shoulder/elbow plane is at a fixed offset along the shoulder
+  // axis from the base axis, and has to contain the wrist target once rotated
+  // about the base axis. This gives x * cos(q) + y * sin(q) = c.
+  const Eigen::Vector3d& base_axis = axes[0];
+  const Eigen::Vector3d& shoulder_axis = axes[1];
+  Eigen::Vector3d wrist_offset = wrist_target - points[0];
+  double axis_dot = base_axis.dot(shoulder_axis);
+  double c = (wrist_center - points[0]).dot(shoulder_axis) - axis_dot * base_axis.dot(wrist_offset);
+  double x = wrist_offset.dot(shoulder_axis - axis_dot * base_axis);
+  double y = wrist_offset.dot(base_axis.cross(shoulder_axis));
+  double radius = std::hypot(x, y);
+  if (radius < solution_tolerance || std::abs(c) > radius + solution_tolerance)
+    return false;
+  double base_angle = std::atan2(y, x);
+  double base_spread = std::acos(clamp(c / radius, -1, 1));
+
+  double upper_arm = (elbow - shoulder).norm();
+  double forearm = (wrist - elbow).norm();
+  double upper_arm_angle = angle(elbow - shoulder);
+  double forearm_angle = angle(wrist - elbow);
+
+  std::vector<Eigen::VectorXd> candidates;
+  Eigen::VectorXd positions = Eigen::VectorXd::Zero(dof_count);
+  for (double base_sign : {1.0, -1.0}) {
+    if (base_sign < 0 && base_spread == 0)
+      break;
+    positions[0] = base_angle + base_sign * base_spread;
+
+    // Shoulder and elbow: a planar two link arm reaching for the wrist target,
+    // with the base moved back to zero
+    Eigen::Vector3d wrist_zero = points[0] +
+      Eigen::AngleAxisd(-positions[0], base_axis) * wrist_offset;
+    Eigen::Vector2d reach =
+      Eigen::Vector2d(wrist_zero.dot(plane_x), wrist_zero.dot(plane_y)) - shoulder;
+    double cos_elbow = (reach.squaredNorm() - upper_arm * upper_arm - forearm * forearm) /
+      (2 * upper_arm * forearm);
+    if (std::abs(cos_elbow) > 1 + solution_tolerance)
+      continue;
+    double elbow_angle = std::acos(clamp(cos_elbow, -1, 1));
+
+    for (double elbow_sign : {1.0, -1.0}) {
+      if (elbow_sign < 0 && elbow_angle == 0)
+        break;
+      double relative = elbow_sign * elbow_angle;
+      positions[1] = angle(reach) -
+        std::atan2(forearm * std::sin(relative), upper_arm + forearm * std::cos(relative)) -
+        upper_arm_angle;
+      positions[2] = elbow_direction * (relative - forearm_angle + upper_arm_angle);
+
+      Eigen::Matrix3d arm_rotation =
+        (Eigen::AngleAxisd(positions[0], axes[0]) *
+         Eigen::AngleAxisd(positions[1], axes[1]) *
+         Eigen::AngleAxisd(positions[2], axes[2])).toRotationMatrix();
+      solveWrist(arm_rotation.transpose() * target_rotation * zero_rotation.transpose(),
+        positions, candidates);
+    }
+  }
+
+  // Keep the exact solutions; for 5 joints, the target orientation may not be
+  // reachable at all.
+  for (auto& candidate : candidates) {
+    for (size_t i = 0; i < dof_count; ++i)
+      candidate[i] = std::remainder(candidate[i], 2 * M_PI);
+    Eigen::Matrix4d error = getEndEffector(candidate) - target;
+    if (error.topRightCorner<3,1>().norm() > solution_tolerance ||
+      error.topLeftCorner<3,3>().norm() > solution_tolerance) {
+      continue;
+    }
+    bool duplicate = false;
+    for (auto& solution : solutions)
+      duplicate = duplicate || (solution - candidate).norm() < solution_tolerance;
+    if (!duplicate)
+      solutions.push_back(candidate);
+  }
+
+  return !solutions.empty();
+}
+
+void HebirosAnalyticIK::solveWrist(const Eigen::Matrix3d& rotation, Eigen::VectorXd positions,
+  std::vector<Eigen::VectorXd>& solutions) const {
+
+  // The wrist joints (about axes through the wrist center) have to make up
+  // "rotation" by themselves.
+  const Eigen::Vector3d& first = axes[3];
+  const Eigen::Vector3d& second = axes[4];
+
+  if (dof_count == 5) {
+    // The second axis is unmoved by the second joint
+    positions[3] = rotationAngle(first, second, rotation * second);
+    Eigen::Vector3d reference = second.unitOrthogonal();
+    positions[4] = rotationAngle(second, reference,
+      Eigen::AngleAxisd(-positions[3], first) * rotation * reference);
+    solutions.push_back(positions);
+    return;
+  }
+
+  // The third axis is unmoved by the third joint, so the first two joints
+  // have to rotate it onto rotation * third; the intermediate vector is one
+  // of the (up to) two intersections of the cones around the first and
+  // second axes (Paden-Kahan subproblem 2).
+  const Eigen::Vector3d& third = axes[5];
+  Eigen::Vector3d goal = rotation * third;
+  double axis_dot = first.dot(second);
+  double denominator = axis_dot * axis_dot - 1;
+  double alpha = (axis_dot * second.dot(third) - first.dot(goal)) / denominator;
+  double beta = (axis_dot * first.dot(goal) - second.dot(third)) / denominator;
+  Eigen::Vector3d normal = first.cross(second);
+  double gamma_squared = (third.squaredNorm() - alpha * alpha - beta * beta -
+    2 * alpha * beta * axis_dot) / normal.squaredNorm();
+  if (gamma_squared < -solution_tolerance)
+    return;
+  double gamma = std::sqrt(std::max(gamma_squared, 0.0));
+
+  for (double sign : {1.0, -1.0}) {
+    if (sign < 0 && gamma == 0)
+      break;
+    Eigen::Vector3d intermediate = alpha * first + beta * second + sign * gamma * normal;
+    positions[4] = rotationAngle(second, third, intermediate);
+    positions[3] = rotationAngle(first, intermediate, goal);
+    Eigen::Vector3d reference = third.unitOrthogonal();
+    positions[5] = rotationAngle(third, reference,
+      Eigen::AngleAxisd(-positions[4], second) * Eigen::AngleAxisd(-positions[3], first) *
+      rotation * reference);
+    solutions.push_back(positions);
+  }
+}
+
+Eigen::Matrix4d HebirosAnalyticIK::getEndEffector(const Eigen::VectorXd& positions) const {
+  // Product of exponentials: each joint rotates everything after it about its
+  // axis, as placed at zero positions.
+  Eigen::Matrix4d transform = Eigen::Matrix4d::Identity();
+  for (size_t i = 0; i < dof_count; ++i) {
+    Eigen::Matrix4d joint = Eigen::Matrix4d::Identity();
+    Eigen::Matrix3d rotation = Eigen::AngleAxisd(positions[i], axes[i]).toRotationMatrix();
+    joint.topLeftCorner<3,3>() = rotation;
+    joint.topRightCorner<3,1>() = points[i] - rotation * points[i];
+    transform = transform * joint;
+  }
+  return transform * end_effector;
+}
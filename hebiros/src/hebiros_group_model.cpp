@@ -0,0 +1,459 @@
+#include "hebiros_group_model.h"
+
+#include "hebiros_group.h"
+#include "hebiros_parameters.h"
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+// Damping of the Jacobian pseudo-inverse for twist commands; this bounds joint
+// velocities near singularities at the cost of end effector tracking there.
+static constexpr double twist_damping = 0.05;
+
+// Damping of the least squares wrench estimate; this keeps the estimate
+// bounded for directions the joints cannot resist (e.g., near singularities).
+static constexpr double wrench_damping = 0.01;
+
+// Longest step that twist commands are integrated over, so a stalled loop
+// does not cause a jump.
+static constexpr double max_twist_step = 0.1;
+
+HebirosGroupModel::HebirosGroupModel(const HebirosModel& model_, const HebirosGroup& group)
+ : model(model_), decimation_count(0), gravity_compensation(false),
+   twist_active(false) {
+
+  // Group joints are named "family/name"; groups created from a URDF also
+  // know the full URDF joint name, which is what the model uses.
+  const std::vector<std::string>& joint_names = model.getJointNames();
+  joint_indices.assign(joint_names.size(), -1);
+  for (auto& joint : group.joints) {
+    auto full_name = group.joint_full_names.find(joint.first);
+    for (size_t i = 0; i < joint_names.size(); ++i) {
+      if (joint_names[i] == joint.first ||
+        (full_name != group.joint_full_names.end() && joint_names[i] == full_name->second)) {
+        joint_indices[i] = joint.second;
+      }
+    }
+  }
+
+  positions.setZero(joint_names.size());
+
+  group_joints = group.joints;
+  group_joint_names.resize(group.size);
+  for (auto& joint : group.joints) {
+    if (joint.second >= 0 && joint.second < group.size)
+      group_joint_names[joint.second] = joint.first;
+  }
+
+  const std::vector<HebirosModel::Chain>& chains = model.getChains();
+  chain_states.resize(chains.size());
+  for (size_t i = 0; i < chains.size(); ++i) {
+    chain_states[i].positions.setZero(chains[i].dof_count);
+    chains[i].model->getMasses(chain_states[i].masses);
+    chain_states[i].end.setIdentity();
+  }
+
+  // The IMU is in the housing of the first joint, which (for a serial arm) is
+  // only moved by fixed transforms relative to the base.
+  imu_rotation = chains[0].model->getBaseFrame().topLeftCorner<3,3>();
+  for (auto& element : chains[0].elements) {
+    if (element.type == HebirosModel::Element::Type::Joint)
+      break;
+    Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>> output(element.output);
+    imu_rotation = imu_rotation * output.topLeftCorner<3,3>();
+  }
+  gravity_efforts.setZero(joint_names.size());
+
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  command_position.assign(group.size, nan);
+  command_velocity.assign(group.size, nan);
+  command_effort.assign(group.size, nan);
+  command_msg.name = group_joint_names;
+
+  twist.setZero();
+  twist_positions.setZero(joint_names.size());
+  twist_velocities.setZero(joint_names.size());
+  twist_jacobian.setZero(6, joint_names.size());
+  twist_command_msg.name.resize(joint_names.size());
+  for (size_t i = 0; i < joint_indices.size(); ++i) {
+    if (joint_indices[i] >= 0 && static_cast<size_t>(joint_indices[i]) < group_joint_names.size())
+      twist_command_msg.name[i] = group_joint_names[joint_indices[i]];
+  }
+  twist_command_msg.position.resize(joint_names.size());
+  twist_command_msg.velocity.resize(joint_names.size());
+
+  wrench_efforts.setZero(joint_names.size());
+  wrench_jacobian.setZero(6, joint_names.size());
+  wrench_filtered.setZero();
+  wrench_msg.header.frame_id = model.getBaseName();
+
+  decimation = std::max(HebirosParameters::getInt("hebiros/model_feedback_decimation"), 1);
+
+  const std::vector<std::string>& link_names = model.getLinkNames();
+  tf_msg.transforms.resize(link_names.size());
+  for (size_t i = 0; i < link_names.size(); ++i) {
+    tf_msg.transforms[i].header.frame_id = model.getBaseName();
+    tf_msg.transforms[i].child_frame_id = link_names[i];
+  }
+  end_effector_msg.header.frame_id = model.getBaseName();
+}
+
+bool HebirosGroupModel::isValid() const {
+  for (int index : joint_indices) {
+    if (index < 0)
+      return false;
+  }
+  return true;
+}
+
+const HebirosModel& HebirosGroupModel::getModel() const {
+  return model;
+}
+
+const std::vector<int>& HebirosGroupModel::getJointIndices() const {
+  return joint_indices;
+}
+
+bool HebirosGroupModel::setPositions(const hebiros::FeedbackMsg& feedback_msg) {
+  for (size_t i = 0; i < joint_indices.size(); ++i) {
+    if (static_cast<size_t>(joint_indices[i]) >= feedback_msg.position.size())
+      return false;
+    positions[i] = feedback_msg.position[joint_indices[i]];
+  }
+  return true;
+}
+
+const Eigen::VectorXd& HebirosGroupModel::getPositions() const {
+  return positions;
+}
+
+bool HebirosGroupModel::updateFrames(const ros::Time& stamp) {
+  if (++decimation_count < decimation)
+    return false;
+  decimation_count = 0;
+
+  model.getLinkFrames(positions, output_frames, link_frames, fk_workspace);
+
+  for (size_t i = 0; i < link_frames.size(); ++i) {
+    const Eigen::Matrix4d& frame = link_frames[i];
+    Eigen::Quaterniond rotation(Eigen::Matrix3d(frame.topLeftCorner<3,3>()));
+    geometry_msgs::TransformStamped& transform = tf_msg.transforms[i];
+    transform.header.stamp = stamp;
+    transform.transform.translation.x = frame(0, 3);
+    transform.transform.translation.y = frame(1, 3);
+    transform.transform.translation.z = frame(2, 3);
+    transform.transform.rotation.w = rotation.w();
+    transform.transform.rotation.x = rotation.x();
+    transform.transform.rotation.y = rotation.y();
+    transform.transform.rotation.z = rotation.z();
+  }
+
+  if (!output_frames.empty()) {
+    const Eigen::Matrix4d& frame = output_frames.back();
+    Eigen::Quaterniond rotation(Eigen::Matrix3d(frame.topLeftCorner<3,3>()));
+    end_effector_msg.header.stamp = stamp;
+    end_effector_msg.pose.position.x = frame(0, 3);
+    end_effector_msg.pose.position.y = frame(1, 3);
+    end_effector_msg.pose.position.z = frame(2, 3);
+    end_effector_msg.pose.orientation.w = rotation.w();
+    end_effector_msg.pose.orientation.x = rotation.x();
+    end_effector_msg.pose.orientation.y = rotation.y();
+    end_effector_msg.pose.orientation.z = rotation.z();
+  }
+
+  return true;
+}
+
+void HebirosGroupModel::setGravityCompensation(bool enabled) {
+  gravity_compensation = enabled;
+}
+
+bool HebirosGroupModel::getGravityCompensation() const {
+  return gravity_compensation;
+}
+
+bool HebirosGroupModel::updateGravityEfforts(const hebiros::FeedbackMsg& feedback_msg) {
+  if (!setPositions(feedback_msg))
+    return false;
+
+  Eigen::Vector3d gravity(0, 0, -9.81);
+  if (!joint_indices.empty() &&
+    static_cast<size_t>(joint_indices[0]) < feedback_msg.accelerometer.size()) {
+    const geometry_msgs::Vector3& accel = feedback_msg.accelerometer[joint_indices[0]];
+    Eigen::Vector3d measured(-accel.x, -accel.y, -accel.z);
+    if (measured.norm() > 1e-3)
+      gravity = imu_rotation * measured;
+  }
+
+  const std::vector<HebirosModel::Chain>& chains = model.getChains();
+
+  // Compute each chain's frames relative to its own reference, and the world
+  // transform of that reference (the end of the parent chain).
+  for (size_t i = 0; i < chains.size(); ++i) {
+    const HebirosModel::Chain& chain = chains[i];
+    ChainState& state = chain_states[i];
+    state.positions = positions.segment(chain.dof_offset, chain.dof_count);
+    if (chain.parent < 0)
+      state.reference.setIdentity();
+    else
+      state.reference = chain_states[chain.parent].reference * chain_states[chain.parent].end;
+    chain.model->getFK(HebiFrameTypeCenterOfMass, state.positions, state.com_frames);
+    chain.model->getJ(HebiFrameTypeCenterOfMass, state.positions, state.com_jacobians);
+    if (chain.has_children) {
+      chain.model->getEndEffector(state.positions, state.end);
+      chain.model->getJEndEffector(state.positions, state.end_jacobian);
+    }
+    state.force.setZero();
+    state.moment.setZero();
+  }
+
+  // Children come after their parents, so walking backwards accumulates the
+  // load of every subtree before the chain it hangs from is reached.
+  for (size_t i = chains.size(); i-- > 0;) {
+    const HebirosModel::Chain& chain = chains[i];
+    ChainState& state = chain_states[i];
+    Eigen::Matrix3d rotation = state.reference.topLeftCorner<3,3>();
+    Eigen::Vector3d chain_gravity = rotation.transpose() * gravity;
+    auto efforts = gravity_efforts.segment(chain.dof_offset, chain.dof_count);
+    efforts.setZero();
+
+    // Load of this chain and its children about the chain's reference, in
+    // reference coordinates
+    Eigen::Vector3d force = Eigen::Vector3d::Zero();
+    Eigen::Vector3d moment = Eigen::Vector3d::Zero();
+
+    if (chain.has_children) {
+      Eigen::Vector3d end_force = rotation.transpose() * state.force;
+      Eigen::Vector3d end_moment = rotation.transpose() * state.moment;
+      if (chain.dof_count > 0) {
+        efforts -= state.end_jacobian.topRows<3>().transpose() * end_force +
+          state.end_jacobian.bottomRows<3>().transpose() * end_moment;
+      }
+      force += end_force;
+      moment += end_moment + state.end.topRightCorner<3,1>().cross(end_force);
+    }
+
+    for (size_t j = 0; j < state.com_frames.size(); ++j) {
+      Eigen::Vector3d weight = state.masses[j] * chain_gravity;
+      if (chain.dof_count > 0)
+        efforts -= state.com_jacobians[j].topRows<3>().transpose() * weight;
+      force += weight;
+      moment += state.com_frames[j].topRightCorner<3,1>().cross(weight);
+    }
+
+    if (chain.parent >= 0) {
+      chain_states[chain.parent].force += rotation * force;
+      chain_states[chain.parent].moment += rotation * moment;
+    }
+  }
+
+  return true;
+}
+
+const Eigen::VectorXd& HebirosGroupModel::getGravityEfforts() const {
+  return gravity_efforts;
+}
+
+bool HebirosGroupModel::setCommand(const sensor_msgs::JointState& joint_state_msg,
+  const hebiros::SettingsMsg* settings_msg) {
+
+  if (!gravity_compensation)
+    return false;
+
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  std::fill(command_position.begin(), command_position.end(), nan);
+  std::fill(command_velocity.begin(), command_velocity.end(), nan);
+  std::fill(command_effort.begin(), command_effort.end(), nan);
+
+  for (size_t i = 0; i < joint_state_msg.name.size(); ++i) {
+    auto joint = group_joints.find(joint_state_msg.name[i]);
+    if (joint == group_joints.end() ||
+      static_cast<size_t>(joint->second) >= command_position.size()) {
+      continue;
+    }
+    int index = joint->second;
+    if (i < joint_state_msg.position.size())
+      command_position[index] = joint_state_msg.position[i];
+    if (i < joint_state_msg.velocity.size())
+      command_velocity[index] = joint_state_msg.velocity[i];
+    if (i < joint_state_msg.effort.size())
+      command_effort[index] = joint_state_msg.effort[i];
+  }
+  command_time = ros::Time::now();
+
+  if (settings_msg)
+    command_settings = *settings_msg;
+
+  return true;
+}
+
+const hebiros::CommandMsg& HebirosGroupModel::getCommand(
+  const hebiros::FeedbackMsg* hold_feedback) {
+  size_t size = group_joint_names.size();
+  double nan = std::numeric_limits<double>::quiet_NaN();
+
+  // A lifetime of 0 means that commands do not expire
+  int lifetime = HebirosParameters::getInt("hebiros/command_lifetime");
+  if (lifetime == 0 || (ros::Time::now() - command_time).toSec() <= lifetime / 1000.0) {
+    command_msg.position = command_position;
+    command_msg.velocity = command_velocity;
+    command_msg.effort = command_effort;
+  } else {
+    command_msg.position.assign(size, nan);
+    command_msg.velocity.assign(size, nan);
+    command_msg.effort.assign(size, nan);
+  }
+
+  for (size_t i = 0; i < joint_indices.size(); ++i) {
+    double& effort = command_msg.effort[joint_indices[i]];
+    effort = (std::isnan(effort) ? 0 : effort) + gravity_efforts[i];
+  }
+
+  if (hold_feedback) {
+    for (size_t i = 0; i < size; ++i) {
+      if (std::isnan(command_msg.position[i]) && i < hold_feedback->position.size())
+        command_msg.position[i] = hold_feedback->position[i];
+      if (std::isnan(command_msg.velocity[i]) && i < hold_feedback->velocity.size())
+        command_msg.velocity[i] = hold_feedback->velocity[i];
+    }
+  }
+
+  command_msg.settings = command_settings;
+  command_settings = hebiros::SettingsMsg();
+
+  return command_msg;
+}
+
+bool HebirosGroupModel::setTwist(const geometry_msgs::Twist& twist_msg) {
+  if (!model.isChain())
+    return false;
+
+  twist << twist_msg.linear.x, twist_msg.linear.y, twist_msg.linear.z,
+    twist_msg.angular.x, twist_msg.angular.y, twist_msg.angular.z;
+  twist_time = ros::Time::now();
+  return true;
+}
+
+bool HebirosGroupModel::updateTwistCommand(const ros::Time& time) {
+  int lifetime = HebirosParameters::getInt("hebiros/command_lifetime");
+  if (twist_time.isZero() ||
+    (lifetime != 0 && (time - twist_time).toSec() > lifetime / 1000.0)) {
+    twist_active = false;
+    return false;
+  }
+
+  double dt = 0;
+  if (!twist_active) {
+    twist_positions = positions;
+    twist_active = true;
+  } else {
+    dt = std::min(std::max((time - twist_update_time).toSec(), 0.0), max_twist_step);
+  }
+  twist_update_time = time;
+
+  // qdot = J^T (J J^T + lambda^2 I)^-1 v
+  model.getModel().getJEndEffector(positions, twist_jacobian);
+  twist_jjt.noalias() = twist_jacobian * twist_jacobian.transpose();
+  twist_jjt.diagonal().array() += twist_damping * twist_damping;
+  twist_solver.compute(twist_jjt);
+  twist_velocities.noalias() = twist_jacobian.transpose() * twist_solver.solve(twist);
+  twist_positions += twist_velocities * dt;
+
+  for (size_t i = 0; i < twist_positions.size(); ++i) {
+    twist_command_msg.position[i] = twist_positions[i];
+    twist_command_msg.velocity[i] = twist_velocities[i];
+  }
+  twist_command_msg.header.stamp = time;
+
+  return true;
+}
+
+bool HebirosGroupModel::updateWrench(const hebiros::FeedbackMsg& feedback_msg,
+  const ros::Time& stamp) {
+
+  if (!model.isChain())
+    return false;
+
+  for (size_t i = 0; i < joint_indices.size(); ++i) {
+    if (static_cast<size_t>(joint_indices[i]) >= feedback_msg.effort.size())
+      return false;
+    wrench_efforts[i] = feedback_msg.effort[joint_indices[i]] - gravity_efforts[i];
+  }
+
+  // F = (J J^T + lambda^2 I)^-1 J (effort - gravity efforts)
+  model.getModel().getJEndEffector(positions, wrench_jacobian);
+  wrench_jjt.noalias() = wrench_jacobian * wrench_jacobian.transpose();
+  wrench_jjt.diagonal().array() += wrench_damping * wrench_damping;
+  wrench_solver.compute(wrench_jjt);
+  wrench.noalias() = wrench_solver.solve(wrench_jacobian * wrench_efforts);
+
+  // First order low pass filter; the cutoff is in Hz, and 0 disables it.
+  double cutoff = HebirosParameters::getDouble("hebiros/wrench_filter_cutoff");
+  if (cutoff <= 0 || wrench_time.isZero()) {
+    wrench_filtered = wrench;
+  } else {
+    double dt = std::max((stamp - wrench_time).toSec(), 0.0);
+    double alpha = 1.0 - std::exp(-2.0 * M_PI * cutoff * dt);
+    wrench_filtered += alpha * (wrench - wrench_filtered);
+  }
+  wrench_time = stamp;
+
+  wrench_msg.header.stamp = stamp;
+  wrench_msg.wrench.force.x = wrench_filtered[0];
+  wrench_msg.wrench.force.y = wrench_filtered[1];
+  wrench_msg.wrench.force.z = wrench_filtered[2];
+  wrench_msg.wrench.torque.x = wrench_filtered[3];
+  wrench_msg.wrench.torque.y = wrench_filtered[4];
+  wrench_msg.wrench.torque.z = wrench_filtered[5];
+
+  return true;
+}
+
+bool HebirosGroupModel::checkTrajectory(const hebi::trajectory::Trajectory& trajectory,
+  double resolution, double mesh_radius, std::string& collision) {
+
+  if (!model.hasCapsules())
+    return true;
+
+  size_t joint_count = trajectory.getJointCount();
+  for (int index : joint_indices) {
+    if (index < 0 || static_cast<size_t>(index) >= joint_count) {
+      collision = "trajectory does not include all model joints";
+      return false;
+    }
+  }
+
+  double duration = trajectory.getDuration();
+  size_t sample_count = resolution > 0 ?
+    static_cast<size_t>(std::ceil(duration / resolution)) + 1 : 2;
+  double step = duration / (sample_count - 1);
+
+  // Sample the whole trajectory first, so the kinematics below run in one
+  // tight loop over reused buffers.
+  collision_group_positions.resize(joint_count);
+  collision_positions.resize(joint_indices.size(), sample_count);
+  for (size_t i = 0; i < sample_count; ++i) {
+    trajectory.getState(trajectory.getStartTime() + i * step,
+      &collision_group_positions, nullptr, nullptr);
+    for (size_t j = 0; j < joint_indices.size(); ++j)
+      collision_positions(j, i) = collision_group_positions[joint_indices[j]];
+  }
+
+  const std::vector<std::string>& link_names = model.getLinkNames();
+  for (size_t i = 0; i < sample_count; ++i) {
+    collision_sample = collision_positions.col(i);
+    model.getLinkFrames(collision_sample, collision_output_frames, collision_link_frames,
+      collision_fk_workspace);
+    size_t link_a, link_b;
+    if (model.findSelfCollision(collision_link_frames, mesh_radius, collision_points,
+      link_a, link_b)) {
+      std::ostringstream description;
+      description << "links " << link_names[link_a] << " and " << link_names[link_b] <<
+        " collide at " << i * step << " s";
+      collision = description.str();
+      return false;
+    }
+  }
+  return true;
+}
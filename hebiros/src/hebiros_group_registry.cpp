@@ -33,4 +33,10 @@ namespace hebiros {
     return _groups.find(name) != _groups.end();
   }
 
+  void HebirosGroupRegistry::forEachGroup(
+    const std::function<void(const std::string&, HebirosGroup&)>& f) {
+    for (auto& group : _groups)
+      f(group.first, *group.second);
+  }
+
 } // namespace hebiros
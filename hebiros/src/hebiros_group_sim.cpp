@@ -0,0 +1,239 @@
+#include "hebiros_group_sim.h"
+
+using hebiros::sim::ActuatorSettings;
+using hebiros::sim::TemperatureModel;
+
+// Rotor inertia of X5 and X8 actuators (kg m^2), estimated from their motors;
+// the inertia at the output grows with the square of the gear ratio.
+static constexpr double rotor_inertia_x5 = 6.0e-7;
+static constexpr double rotor_inertia_x8 = 2.0e-6;
+
+// Viscous friction at the rotor (N m s / rad), reflected to the output like
+// the rotor inertia
+static constexpr double rotor_damping = 7.0e-7;
+
+HebirosGroupSim::HebirosGroupSim() :
+  HebirosGroupGazebo(), command_lifetime(100), feedback_frequency(100),
+  dynamics_model(nullptr) {
+}
+
+void HebirosGroupSim::initialize() {
+
+  // Joints in feedback order; groups created from a URDF know the full joint
+  // name ("family/name/X5_1"), which ends with the module type.
+  std::vector<std::string> names(size);
+  for (auto& joint : joints) {
+    if (joint.second >= 0 && joint.second < size)
+      names[joint.second] = joint.first;
+  }
+
+  positions.setZero(size);
+  velocities.setZero(size);
+  efforts.setZero(size);
+  reflected_inertia.resize(size);
+  damping.resize(size);
+  mass_matrix.resize(size, size);
+  momentum.resize(size);
+  command_indices.resize(size);
+  default_gains.resize(size);
+
+  for (int i = 0; i < size; ++i) {
+    std::string model_name;
+    auto full_name = joint_full_names.find(names[i]);
+    if (full_name != joint_full_names.end()) {
+      size_t separator = full_name->second.rfind('/');
+      if (separator != std::string::npos)
+        model_name = full_name->second.substr(separator + 1);
+    }
+
+    bool is_x8 = ActuatorSettings::isX8(model_name);
+    double gear_ratio = ActuatorSettings::getGearRatio(model_name);
+    default_gains[i] = &ActuatorSettings::getDefaultGains(model_name);
+    ActuatorSettings::addDefaults(names[i], *default_gains[i], settings);
+    controller.addJoint(gear_ratio, is_x8,
+      is_x8 ? TemperatureModel::createX8() : TemperatureModel::createX5());
+
+    reflected_inertia[i] = (is_x8 ? rotor_inertia_x8 : rotor_inertia_x5) *
+      gear_ratio * gear_ratio;
+    damping[i] = rotor_damping * gear_ratio * gear_ratio;
+    command_indices[i] = i;
+  }
+
+  sim_feedback.name = names;
+  sim_feedback.position.resize(size);
+  sim_feedback.motor_winding_temperature.resize(size);
+  sim_feedback.motor_housing_temperature.resize(size);
+  sim_feedback.board_temperature.resize(size);
+  sim_feedback.velocity.resize(size);
+  sim_feedback.effort.resize(size);
+  sim_feedback.position_command.resize(size);
+  sim_feedback.velocity_command.resize(size);
+  sim_feedback.effort_command.resize(size);
+  sim_feedback.accelerometer.resize(size);
+  sim_feedback.gyro.resize(size);
+}
+
+void HebirosGroupSim::setCommand(const hebiros::CommandMsg& command_msg,
+  const ros::Time& time) {
+
+  command_target = command_msg;
+
+  for (int i = 0; i < command_msg.name.size(); i++) {
+    auto joint = joints.find(command_msg.name[i]);
+    if (joint != joints.end() && joint->second >= 0 && joint->second < size) {
+      command_indices[joint->second] = i;
+      ActuatorSettings::change(command_target.settings, i, *default_gains[joint->second],
+        settings);
+    }
+  }
+
+  controller.setCommand(command_target, settings, command_indices, time);
+}
+
+void HebirosGroupSim::setFeedbackFrequency(float frequency_hz) {
+  feedback_frequency = frequency_hz;
+}
+
+void HebirosGroupSim::setCommandLifetime(float lifetime_ms) {
+  command_lifetime = lifetime_ms;
+}
+
+bool HebirosGroupSim::step(double dt, const ros::Time& time) {
+
+  if (controller.acquireCommand())
+    start_time = controller.getCommand().time;
+
+  // Report the state and temperatures from before this step, as the plugin
+  // does; the effort is the force applied over the last step.
+  for (int i = 0; i < size; ++i) {
+    controller.position[i] = positions[i];
+    controller.velocity[i] = velocities[i];
+    controller.effort[i] = efforts[i];
+
+    sim_feedback.position[i] = positions[i];
+    sim_feedback.velocity[i] = velocities[i];
+    sim_feedback.effort[i] = efforts[i];
+    sim_feedback.motor_winding_temperature[i] = controller.winding_temperature[i];
+    sim_feedback.motor_housing_temperature[i] = controller.housing_temperature[i];
+    sim_feedback.board_temperature[i] = controller.body_temperature[i];
+  }
+
+  efforts.setZero();
+  if (controller.hasCommand()) {
+    controller.update(dt);
+    const hebiros::sim::ActuatorController::Command& command = controller.getCommand();
+
+    bool command_active = (command_lifetime == 0) ||
+      ((time - start_time).toSec() <= command_lifetime/1000.0);
+
+    for (int i = 0; i < size; ++i) {
+      if (command_active)
+        efforts[i] = controller.force[i];
+
+      if (command.has_position_target[i])
+        sim_feedback.position_command[i] = command.position_target[i];
+      if (command.has_velocity_target[i])
+        sim_feedback.velocity_command[i] = command.velocity_target[i];
+      if (command.has_effort_target[i])
+        sim_feedback.effort_command[i] = command.effort_target[i];
+    }
+  }
+
+  // Semi-implicit Euler step; friction is taken at the new velocity, so the
+  // step is stable for any dt:
+  //   (M + dt B) v' = M v + dt (effort + gravity),  q' = q + dt v'
+  mass_matrix.setZero();
+  mass_matrix.diagonal() = reflected_inertia;
+  momentum = dt * efforts;
+  addModelDynamics(dt);
+  momentum.noalias() += mass_matrix * velocities;
+  mass_matrix.diagonal() += dt * damping;
+
+  solver.compute(mass_matrix);
+  velocities = solver.solve(momentum);
+  positions += dt * velocities;
+
+  if ((time - prev_feedback_time).toSec() >= 1.0/feedback_frequency) {
+    prev_feedback_time = time;
+    return true;
+  }
+  return false;
+}
+
+const hebiros::FeedbackMsg& HebirosGroupSim::getFeedback() const {
+  return sim_feedback;
+}
+
+const hebiros::sim::ActuatorController& HebirosGroupSim::getController() const {
+  return controller;
+}
+
+void HebirosGroupSim::addModelDynamics(double dt) {
+
+  std::lock_guard<std::mutex> lock(model_mutex);
+  if (!model)
+    return;
+
+  const HebirosModel& hebiros_model = model->getModel();
+  if (!hebiros_model.isChain()) {
+    ROS_WARN_ONCE("Models with branches are not simulated; their joints move independently");
+    return;
+  }
+
+  const HebirosModel::Chain& chain = hebiros_model.getChains()[0];
+  const std::vector<int>& joint_indices = model->getJointIndices();
+
+  if (dynamics_model != &hebiros_model) {
+    dynamics_model = &hebiros_model;
+    model_positions.resize(joint_indices.size());
+    model_mass_matrix.resize(joint_indices.size(), joint_indices.size());
+    model_gravity.resize(joint_indices.size());
+    chain.model->getMasses(masses);
+
+    // Rotational inertia of each rigid body about its center of mass (xx, yy,
+    // zz, xy, xz, yz); there is one center of mass frame per rigid body. If
+    // that does not hold, the bodies are treated as point masses.
+    inertias.clear();
+    for (auto& element : chain.elements) {
+      if (element.type != HebirosModel::Element::Type::RigidBody)
+        continue;
+      const double* i = element.inertia;
+      Eigen::Matrix3d inertia;
+      inertia << i[0], i[3], i[4],
+                 i[3], i[1], i[5],
+                 i[4], i[5], i[2];
+      inertias.push_back(inertia);
+    }
+    if (inertias.size() != static_cast<size_t>(masses.size()))
+      inertias.clear();
+  }
+
+  for (size_t i = 0; i < joint_indices.size(); ++i)
+    model_positions[i] = positions[joint_indices[i]];
+
+  chain.model->getFK(HebiFrameTypeCenterOfMass, model_positions, com_frames);
+  chain.model->getJ(HebiFrameTypeCenterOfMass, model_positions, com_jacobians);
+
+  // M = sum of Jv^T m Jv + Jw^T R I R^T Jw, and the generalized gravity force
+  // sum of Jv^T m g, over all bodies (in the model's base frame)
+  Eigen::Vector3d gravity(0, 0, -9.81);
+  model_mass_matrix.setZero();
+  model_gravity.setZero();
+  for (size_t j = 0; j < com_jacobians.size(); ++j) {
+    auto linear = com_jacobians[j].topRows<3>();
+    model_mass_matrix.noalias() += masses[j] * linear.transpose() * linear;
+    model_gravity.noalias() += linear.transpose() * (masses[j] * gravity);
+    if (!inertias.empty()) {
+      auto angular = com_jacobians[j].bottomRows<3>();
+      Eigen::Matrix3d rotation = com_frames[j].topLeftCorner<3,3>();
+      Eigen::Matrix3d world_inertia = rotation * inertias[j] * rotation.transpose();
+      model_mass_matrix.noalias() += angular.transpose() * world_inertia * angular;
+    }
+  }
+
+  for (size_t a = 0; a < joint_indices.size(); ++a) {
+    for (size_t b = 0; b < joint_indices.size(); ++b)
+      mass_matrix(joint_indices[a], joint_indices[b]) += model_mass_matrix(a, b);
+    momentum[joint_indices[a]] += dt * model_gravity[a];
+  }
+}
@@ -1,51 +1,324 @@
 #include "hebiros_model.h"
 
-#include "hebiros.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 
-std::map<std::string, HebirosModel> HebirosModel::models;
+HebirosModel::HebirosModel(std::vector<Chain> chains_, std::string base_name_)
+ : chains(std::move(chains_)), base_name(std::move(base_name_)) {
 
-bool HebirosModel::load(const std::string& name, const std::string& description_param) {
+  // Each link moves with the last joint before it in the tree (or -1, with the
+  // base); links that move with the same joint are rigidly attached. Each
+  // joint's parent is the joint its parent link moves with.
+  std::vector<int> link_joints;
+  std::vector<int> joint_parents;
+  std::vector<int> chain_end_joints(chains.size());
 
-  // Try to load:
-  urdf::Model model;
-  bool success = loadURDF(description_param, model);
-  if (!success)
-    return false;
+  // There is one output frame per element, and chains are stored in frame
+  // order.
+  size_t output_offset = 0;
+  for (size_t i = 0; i < chains.size(); ++i) {
+    const Chain& chain = chains[i];
+    output_offsets.push_back(output_offset);
+    output_offset += chain.elements.size();
 
-  std::unique_ptr<hebi::robot_model::RobotModel> robot_model = parseURDF(model);
-  if (!robot_model)
-    return false;
+    int joint = chain.parent < 0 ? -1 : chain_end_joints[chain.parent];
+    std::vector<size_t> element_links(chain.elements.size());
+    for (size_t j = 0; j < chain.elements.size(); ++j) {
+      if (chain.elements[j].type == Element::Type::Joint) {
+        joint_parents.push_back(joint);
+        joint = static_cast<int>(joint_names.size());
+        joint_names.push_back(chain.element_names[j]);
+      } else {
+        element_links[j] = link_names.size();
+        link_joints.push_back(joint);
+        link_names.push_back(chain.element_names[j]);
+      }
+    }
+    chain_end_joints[i] = joint;
 
-  models.emplace(name, std::move(robot_model));
-  return true;
-}
+    for (auto& capsule : chain.capsules) {
+      capsules.push_back(capsule);
+      capsule_links.push_back(element_links[capsule.element]);
+    }
+  }
+
+  // Only check links that are neither rigidly attached nor connected by a
+  // single joint
+  for (size_t a = 0; a < capsules.size(); ++a) {
+    for (size_t b = a + 1; b < capsules.size(); ++b) {
+      int joint_a = link_joints[capsule_links[a]];
+      int joint_b = link_joints[capsule_links[b]];
+      bool adjacent = joint_a == joint_b ||
+        (joint_b >= 0 && joint_parents[joint_b] == joint_a) ||
+        (joint_a >= 0 && joint_parents[joint_a] == joint_b);
+      if (!adjacent)
+        collision_pairs.emplace_back(a, b);
+    }
+  }
 
+  analytic_ik = HebirosAnalyticIK::create(*this);
+}
 
-HebirosModel::HebirosModel(std::unique_ptr<hebi::robot_model::RobotModel> model_)
- : model(std::move(model_)) {
+hebi::robot_model::RobotModel& HebirosModel::getModel() {
+  return *chains[0].model;
 }
 
-HebirosModel* HebirosModel::getModel(const std::string& model_name) {
-  if (models.count(model_name) == 0)
+std::unique_ptr<HebirosModel> HebirosModel::fromURDF(const urdf::Model& urdf) {
+  std::vector<Chain> chains;
+  std::string base_name;
+  if (!parseURDF(urdf, chains, base_name) || !buildChains(chains))
     return nullptr;
-  return &models.at(model_name);
+  return std::unique_ptr<HebirosModel>(new HebirosModel(std::move(chains), std::move(base_name)));
 }
 
-hebi::robot_model::RobotModel& HebirosModel::getModel() {
-  return *model;
+const HebirosReachabilityMap* HebirosModel::getReachabilityMap() const {
+  return reachability_map.get();
+}
+
+void HebirosModel::setReachabilityMap(std::unique_ptr<HebirosReachabilityMap> map) {
+  reachability_map = std::move(map);
+}
+
+const hebi::robot_model::RobotModel& HebirosModel::getModel() const {
+  return *chains[0].model;
+}
+
+const std::vector<HebirosModel::Chain>& HebirosModel::getChains() const {
+  return chains;
+}
+
+bool HebirosModel::isChain() const {
+  return chains.size() == 1;
 }
 
-bool HebirosModel::loadURDF(const std::string& description_param, urdf::Model& model) {
+size_t HebirosModel::getDoFCount() const {
+  size_t dofs = 0;
+  for (auto& chain : chains)
+    dofs += chain.dof_count;
+  return dofs;
+}
+
+bool HebirosModel::solveIK(const Eigen::Matrix4d& target,
+  const Eigen::VectorXd& initial_positions, std::vector<Eigen::VectorXd>& solutions,
+  bool& analytic) const {
 
-  if (!model.initParam(description_param)) {
-    ROS_WARN_STREAM("Could not load " << description_param);
+  solutions.clear();
+  analytic = false;
+  if (!isChain() || initial_positions.size() != getDoFCount())
     return false;
+
+  if (analytic_ik && analytic_ik->solve(target, solutions)) {
+    analytic = true;
+    std::sort(solutions.begin(), solutions.end(),
+      [&initial_positions](const Eigen::VectorXd& a, const Eigen::VectorXd& b) {
+        return (a - initial_positions).squaredNorm() < (b - initial_positions).squaredNorm();
+      });
+    return true;
   }
 
-  ROS_INFO_STREAM("Loaded URDF from " << description_param);
+  Eigen::VectorXd result;
+  Eigen::Vector3d position = target.topRightCorner<3,1>();
+  Eigen::Matrix3d rotation = target.topLeftCorner<3,3>();
+  auto ik_result = getModel().solveIK(initial_positions, result,
+    hebi::robot_model::EndEffectorPositionObjective(position),
+    hebi::robot_model::EndEffectorSO3Objective(rotation));
+  if (ik_result.result != HebiStatusSuccess)
+    return false;
+  solutions.push_back(result);
   return true;
 }
-    
+
+size_t HebirosModel::getFrameCount(HebiFrameType frame_type) const {
+  size_t frame_count = 0;
+  for (auto& chain : chains)
+    frame_count += chain.model->getFrameCount(frame_type);
+  return frame_count;
+}
+
+const std::string& HebirosModel::getBaseName() const {
+  return base_name;
+}
+
+const std::vector<std::string>& HebirosModel::getJointNames() const {
+  return joint_names;
+}
+
+const std::vector<std::string>& HebirosModel::getLinkNames() const {
+  return link_names;
+}
+
+void HebirosModel::getFK(HebiFrameType frame_type, const Eigen::VectorXd& positions,
+  hebi::robot_model::Matrix4dVector& frames) const {
+
+  FKWorkspace workspace;
+  getFK(frame_type, positions, frames, workspace);
+}
+
+void HebirosModel::getFK(HebiFrameType frame_type, const Eigen::VectorXd& positions,
+  hebi::robot_model::Matrix4dVector& frames, FKWorkspace& workspace) const {
+
+  size_t frame_count = getFrameCount(frame_type);
+  if (frames.size() != frame_count)
+    frames.resize(frame_count);
+
+  // Simple case; no tree to traverse
+  if (isChain()) {
+    chains[0].model->getFK(frame_type, positions, frames);
+    return;
+  }
+
+  if (workspace.chain_positions.size() != chains.size()) {
+    workspace.chain_positions.resize(chains.size());
+    workspace.chain_frames.resize(chains.size());
+    workspace.chain_ends.resize(chains.size());
+    for (size_t i = 0; i < chains.size(); ++i)
+      workspace.chain_positions[i].resize(chains[i].dof_count);
+  }
+
+  // World transform of the end of each chain; only filled in for chains with
+  // children, and read by those children as their base transform.
+  hebi::robot_model::Matrix4dVector& chain_ends = workspace.chain_ends;
+
+  size_t frame_index = 0;
+  for (size_t i = 0; i < chains.size(); ++i) {
+    const Chain& chain = chains[i];
+    Eigen::VectorXd& chain_positions = workspace.chain_positions[i];
+    hebi::robot_model::Matrix4dVector& chain_frames = workspace.chain_frames[i];
+    chain_positions = positions.segment(chain.dof_offset, chain.dof_count);
+    chain.model->getFK(frame_type, chain_positions, chain_frames);
+
+    if (chain.parent < 0) {
+      for (auto& frame : chain_frames)
+        frames[frame_index++] = frame;
+    } else {
+      const Eigen::Matrix4d& base = chain_ends[chain.parent];
+      for (auto& frame : chain_frames)
+        frames[frame_index++] = base * frame;
+    }
+
+    if (chain.has_children) {
+      Eigen::Matrix4d end;
+      if (frame_type == HebiFrameTypeOutput && !chain_frames.empty())
+        end = chain_frames.back();
+      else
+        chain.model->getEndEffector(chain_positions, end);
+      chain_ends[i] = chain.parent < 0 ? end : chain_ends[chain.parent] * end;
+    }
+  }
+}
+
+void HebirosModel::getLinkFrames(const Eigen::VectorXd& positions,
+  hebi::robot_model::Matrix4dVector& output_frames,
+  hebi::robot_model::Matrix4dVector& link_frames, FKWorkspace& workspace) const {
+
+  getFK(HebiFrameTypeOutput, positions, output_frames, workspace);
+  if (link_frames.size() != link_names.size())
+    link_frames.resize(link_names.size());
+
+  // A link's frame is the output frame of the element before it; the first
+  // link of a chain sits at the chain's base frame, which for a branch is
+  // relative to the end (last output frame) of its parent chain.
+  size_t link_index = 0;
+  for (size_t i = 0; i < chains.size(); ++i) {
+    const Chain& chain = chains[i];
+    size_t offset = output_offsets[i];
+    for (size_t j = 0; j < chain.elements.size(); ++j) {
+      if (chain.elements[j].type != Element::Type::RigidBody)
+        continue;
+      if (j > 0) {
+        link_frames[link_index++] = output_frames[offset + j - 1];
+      } else if (chain.parent < 0) {
+        link_frames[link_index++] = chain.model->getBaseFrame();
+      } else {
+        const Chain& parent = chains[chain.parent];
+        size_t parent_end = output_offsets[chain.parent] + parent.elements.size() - 1;
+        link_frames[link_index++] = output_frames[parent_end] * chain.model->getBaseFrame();
+      }
+    }
+  }
+}
+
+bool HebirosModel::hasCapsules() const {
+  return !capsules.empty();
+}
+
+static double clamp01(double value) {
+  return std::min(std::max(value, 0.0), 1.0);
+}
+
+// Squared distance between the segments p1-q1 and p2-q2, from their closest
+// points (Ericson, Real-Time Collision Detection, 5.1.9)
+static double segmentDistanceSquared(const Eigen::Vector3d& p1, const Eigen::Vector3d& q1,
+  const Eigen::Vector3d& p2, const Eigen::Vector3d& q2) {
+
+  const double epsilon = 1e-12;
+  Eigen::Vector3d d1 = q1 - p1;
+  Eigen::Vector3d d2 = q2 - p2;
+  Eigen::Vector3d r = p1 - p2;
+  double a = d1.squaredNorm();
+  double e = d2.squaredNorm();
+  double f = d2.dot(r);
+
+  double s = 0;
+  double t = 0;
+  if (a <= epsilon && e <= epsilon)
+    return r.squaredNorm();
+  if (a <= epsilon) {
+    t = clamp01(f / e);
+  } else {
+    double c = d1.dot(r);
+    if (e <= epsilon) {
+      s = clamp01(-c / a);
+    } else {
+      double b = d1.dot(d2);
+      double denominator = a * e - b * b;
+      s = denominator > epsilon ? clamp01((b * f - c * e) / denominator) : 0;
+      t = (b * s + f) / e;
+      if (t < 0) {
+        t = 0;
+        s = clamp01(-c / a);
+      } else if (t > 1) {
+        t = 1;
+        s = clamp01((b - c) / a);
+      }
+    }
+  }
+  return (p1 + d1 * s - p2 - d2 * t).squaredNorm();
+}
+
+bool HebirosModel::findSelfCollision(const hebi::robot_model::Matrix4dVector& link_frames,
+  double mesh_radius, std::vector<Eigen::Vector3d>& points,
+  size_t& link_a, size_t& link_b) const {
+
+  // Capsule end points in the base frame
+  if (points.size() != 2 * capsules.size())
+    points.resize(2 * capsules.size());
+  for (size_t i = 0; i < capsules.size(); ++i) {
+    const Eigen::Matrix4d& frame = link_frames[capsule_links[i]];
+    points[2 * i] = frame.topLeftCorner<3,3>() * Eigen::Map<const Eigen::Vector3d>(capsules[i].a) +
+      frame.topRightCorner<3,1>();
+    points[2 * i + 1] = frame.topLeftCorner<3,3>() * Eigen::Map<const Eigen::Vector3d>(capsules[i].b) +
+      frame.topRightCorner<3,1>();
+  }
+
+  for (auto& pair : collision_pairs) {
+    const Capsule& a = capsules[pair.first];
+    const Capsule& b = capsules[pair.second];
+    double radius = (a.radius < 0 ? mesh_radius : a.radius) +
+      (b.radius < 0 ? mesh_radius : b.radius);
+    double distance_squared = segmentDistanceSquared(
+      points[2 * pair.first], points[2 * pair.first + 1],
+      points[2 * pair.second], points[2 * pair.second + 1]);
+    if (distance_squared < radius * radius) {
+      link_a = capsule_links[pair.first];
+      link_b = capsule_links[pair.second];
+      return true;
+    }
+  }
+  return false;
+}
+
 class UnsupportedStructureException : public std::exception {
   public:
     UnsupportedStructureException(const std::string& structure_type) :
@@ -80,7 +353,160 @@ Eigen::MatrixXd ROSPoseToEigenMatrix(const urdf::Pose& pose) {
   return res;
 }
 
-void parseInner(const urdf::Link& link, hebi::robot_model::RobotModel& model) {
+// Copies a 4x4 transform into a row major array, as used by the C API
+void toRowMajor(const Eigen::Matrix4d& matrix, double* array) {
+  Eigen::Map<Eigen::Matrix<double, 4, 4, Eigen::RowMajor>> tmp(array);
+  tmp = matrix;
+}
+
+Eigen::Matrix4d fromRowMajor(const double* array) {
+  Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>> tmp(array);
+  return tmp;
+}
+
+void addRigidBody(HebirosModel::Chain& chain, const std::string& name,
+  const Eigen::Matrix4d& com, const Eigen::VectorXd& inertia, double mass,
+  const Eigen::Matrix4d& output) {
+  HebirosModel::Element element = {};
+  element.type = HebirosModel::Element::Type::RigidBody;
+  element.joint_type = HebiJointTypeRotationX;
+  toRowMajor(com, element.com);
+  for (size_t i = 0; i < 6; ++i)
+    element.inertia[i] = inertia[i];
+  element.mass = mass;
+  toRowMajor(output, element.output);
+  chain.elements.push_back(element);
+  chain.element_names.push_back(name);
+}
+
+void addJoint(HebirosModel::Chain& chain, const std::string& name, HebiJointType joint_type) {
+  HebirosModel::Element element = {};
+  element.type = HebirosModel::Element::Type::Joint;
+  element.joint_type = joint_type;
+  chain.elements.push_back(element);
+  chain.element_names.push_back(name);
+}
+
+// Approximates the collision geometry of the link that was just added to the
+// chain by capsules. "child_joints" are the origins of the link's child joints
+// (in the link frame), which give the extent of links with mesh geometry.
+void addCapsules(const urdf::Link& link, HebirosModel::Chain& chain,
+  const std::vector<Eigen::Vector3d>& child_joints) {
+
+  HebirosModel::Capsule capsule = {};
+  capsule.element = chain.elements.size() - 1;
+
+  bool has_mesh = false;
+  for (auto& collision : link.collision_array) {
+    if (!collision || !collision->geometry)
+      continue;
+
+    // Half of the capsule's segment, in the collision frame
+    Eigen::Vector3d half_segment = Eigen::Vector3d::Zero();
+    const urdf::Geometry& geometry = *collision->geometry;
+    if (geometry.type == urdf::Geometry::SPHERE) {
+      capsule.radius = static_cast<const urdf::Sphere&>(geometry).radius;
+    } else if (geometry.type == urdf::Geometry::CYLINDER) {
+      auto& cylinder = static_cast<const urdf::Cylinder&>(geometry);
+      capsule.radius = cylinder.radius;
+      half_segment.z() = cylinder.length / 2;
+    } else if (geometry.type == urdf::Geometry::BOX) {
+      // Along the longest side, enclosing the box's cross section
+      auto& dim = static_cast<const urdf::Box&>(geometry).dim;
+      Eigen::Vector3d half_size(dim.x / 2, dim.y / 2, dim.z / 2);
+      int longest;
+      half_size.maxCoeff(&longest);
+      half_segment[longest] = half_size[longest];
+      half_size[longest] = 0;
+      capsule.radius = half_size.norm();
+    } else {
+      has_mesh = true;
+      continue;
+    }
+
+    Eigen::Matrix4d origin = ROSPoseToEigenMatrix(collision->origin);
+    Eigen::Map<Eigen::Vector3d>(capsule.a) =
+      origin.topRightCorner<3,1>() - origin.topLeftCorner<3,3>() * half_segment;
+    Eigen::Map<Eigen::Vector3d>(capsule.b) =
+      origin.topRightCorner<3,1>() + origin.topLeftCorner<3,3>() * half_segment;
+    chain.capsules.push_back(capsule);
+  }
+
+  if (!has_mesh)
+    return;
+
+  capsule.radius = -1;
+  Eigen::Map<Eigen::Vector3d>(capsule.a).setZero();
+  Eigen::Map<Eigen::Vector3d>(capsule.b).setZero();
+  if (child_joints.empty())
+    chain.capsules.push_back(capsule);
+  for (auto& child_joint : child_joints) {
+    Eigen::Map<Eigen::Vector3d>(capsule.b) = child_joint;
+    chain.capsules.push_back(capsule);
+  }
+}
+
+// Adds a joint binding the given child joint's parent and child links
+void addChildJoint(const urdf::Joint& child_joint, HebirosModel::Chain& chain) {
+  HebiJointType joint_type = HebiJointTypeRotationX;
+  // Add joint and link:
+  if (child_joint.type == urdf::Joint::REVOLUTE | child_joint.type == urdf::Joint::CONTINUOUS) {
+    if (child_joint.axis.x != 0) {
+      if (child_joint.axis.y != 0 && child_joint.axis.z != 0) {
+        throw UnsupportedJointException("non-principal rotation axis");
+      }
+      joint_type = HebiJointTypeRotationX;
+    } else if (child_joint.axis.y != 0) {
+      if (child_joint.axis.z != 0) { // We know x == 0
+        throw UnsupportedJointException("non-principal rotation axis");
+      }
+      joint_type = HebiJointTypeRotationY;
+    } else if (child_joint.axis.z != 0) {
+      joint_type = HebiJointTypeRotationZ; // We know x == 0 && y == 0
+    }
+    addJoint(chain, child_joint.name, joint_type);
+  } else if (child_joint.type == urdf::Joint::PRISMATIC) {
+    if (child_joint.axis.x != 0) {
+      if (child_joint.axis.y != 0 && child_joint.axis.z != 0) {
+        throw UnsupportedJointException("non-principal translation axis");
+      }
+      joint_type = HebiJointTypeTranslationX;
+    } else if (child_joint.axis.y != 0) {
+      if (child_joint.axis.z != 0) { // We know x == 0
+        throw UnsupportedJointException("non-principal translation axis");
+      }
+      joint_type = HebiJointTypeTranslationY;
+    } else if (child_joint.axis.z != 0) {
+      joint_type = HebiJointTypeTranslationZ; // We know x == 0 && y == 0
+    }
+    addJoint(chain, child_joint.name, joint_type);
+  } else if (child_joint.type == urdf::Joint::FIXED) {
+    // This is supported, we just don't need a "binding" joint in the hebi
+    // robot model classes
+  } else {
+    throw UnsupportedJointException("unknown");
+  }
+}
+
+// Starts a new chain which is attached to the end of the given parent chain
+size_t addChain(std::vector<HebirosModel::Chain>& chains, int parent,
+  const Eigen::Matrix4d& base_frame) {
+  HebirosModel::Chain chain;
+  chain.parent = parent;
+  toRowMajor(base_frame, chain.base_frame);
+  chain.dof_offset = 0;
+  chain.dof_count = 0;
+  chain.has_children = false;
+  chains.push_back(std::move(chain));
+  return chains.size() - 1;
+}
+
+// Adds this link (and recursively, its children) to the end of the given
+// chain. The HEBI robot model currently only supports a single output per
+// element, so when a link has multiple children, the chain ends at that link's
+// frame and each child starts a new chain.
+void parseInner(const urdf::Link& link, std::vector<HebirosModel::Chain>& chains,
+  size_t chain_index) {
   Eigen::Matrix4d com = Eigen::Matrix4d::Identity();
   Eigen::VectorXd inertia;
   inertia.resize(6);
@@ -99,81 +525,59 @@ void parseInner(const urdf::Link& link, hebi::robot_model::RobotModel& model) {
 
   auto& child_links = link.child_links;
 
-  // TODO: support multi-output elements once supported in the C/C++ HEBI API;
-  // the below code would then iterate through the child links
-  if (child_links.size() > 1)
-    throw UnsupportedStructureException("tree");
-
   if (child_links.size() == 0) {
     // TODO: provide some smart default for leaf nodes (e.g., COM * 2)? 
     Eigen::Matrix4d output = Eigen::Matrix4d::Identity();
-    model.addRigidBody(com, inertia, mass, output, false);
+    addRigidBody(chains[chain_index], link.name, com, inertia, mass, output);
+    addCapsules(link, chains[chain_index], {});
     return;
   }
 
-  // hebi robot model "outputs" depends on where the children connect.
-  // (assume one output here for now; can support trees later)
-  {
+  // hebi robot model "outputs" depends on where the children connect; for a
+  // single child, this is the child joint; the chain continues through it.
+  if (child_links.size() == 1) {
     auto& child_link = child_links[0];
     auto& child_joint = child_link->parent_joint;
     Eigen::Matrix4d output =
       ROSPoseToEigenMatrix(child_joint->parent_to_joint_origin_transform);
 
-    // Add rigid body for this link
-    model.addRigidBody(com, inertia, mass, output, false);
+    // Add rigid body for this link, and joint and child link(s)
+    addRigidBody(chains[chain_index], link.name, com, inertia, mass, output);
+    addCapsules(link, chains[chain_index], {output.topRightCorner<3,1>()});
+    addChildJoint(*child_joint, chains[chain_index]);
+    parseInner(*child_link, chains, chain_index);
+    return;
+  }
+
+  // Multiple children; end this chain at the link frame, and attach each child
+  // to a new chain whose base frame is the joint origin relative to this link.
+  addRigidBody(chains[chain_index], link.name, com, inertia, mass, Eigen::Matrix4d::Identity());
+  chains[chain_index].has_children = true;
+
+  std::vector<Eigen::Vector3d> child_joints;
+  for (auto& child_link : child_links) {
+    child_joints.push_back(ROSPoseToEigenMatrix(
+      child_link->parent_joint->parent_to_joint_origin_transform).topRightCorner<3,1>());
   }
+  addCapsules(link, chains[chain_index], child_joints);
 
-  // Add joint(s) to children, and child links (this is written to support
-  // trees)
   for (auto& child_link : child_links) {
     auto& child_joint = child_link->parent_joint;
-    HebiJointType joint_type = HebiJointTypeRotationX;
-    // Add joint and link:
-    if (child_joint->type == urdf::Joint::REVOLUTE | child_joint->type == urdf::Joint::CONTINUOUS) {
-      if (child_joint->axis.x != 0) {
-        if (child_joint->axis.y != 0 && child_joint->axis.z != 0) {
-          throw UnsupportedJointException("non-principal rotation axis");
-        }
-        joint_type = HebiJointTypeRotationX;
-      } else if (child_joint->axis.y != 0) {
-        if (child_joint->axis.z != 0) { // We know x == 0
-          throw UnsupportedJointException("non-principal rotation axis");
-        }
-        joint_type = HebiJointTypeRotationY;
-      } else if (child_joint->axis.z != 0) {
-        joint_type = HebiJointTypeRotationZ; // We know x == 0 && y == 0
-      }
-      model.addJoint(joint_type, false);
-    } else if (child_joint->type == urdf::Joint::PRISMATIC) {
-      if (child_joint->axis.x != 0) {
-        if (child_joint->axis.y != 0 && child_joint->axis.z != 0) {
-          throw UnsupportedJointException("non-principal translation axis");
-        }
-        joint_type = HebiJointTypeTranslationX;
-      } else if (child_joint->axis.y != 0) {
-        if (child_joint->axis.z != 0) { // We know x == 0
-          throw UnsupportedJointException("non-principal translation axis");
-        }
-        joint_type = HebiJointTypeTranslationY;
-      } else if (child_joint->axis.z != 0) {
-        joint_type = HebiJointTypeTranslationZ; // We know x == 0 && y == 0
-      }
-      model.addJoint(joint_type, false);
-    } else if (child_joint->type == urdf::Joint::FIXED) {
-      // This is supported, we just don't need a "binding" joint in the hebi
-      // robot model classes
-    } else {
-      throw UnsupportedJointException("unknown");
-    }
+    size_t child_index = addChain(chains, static_cast<int>(chain_index),
+      ROSPoseToEigenMatrix(child_joint->parent_to_joint_origin_transform));
+
     // This recursively adds this child link (and its children)
-    parseInner(*child_link, model);
-  } 
+    addChildJoint(*child_joint, chains[child_index]);
+    parseInner(*child_link, chains, child_index);
+  }
 }
 
-std::unique_ptr<hebi::robot_model::RobotModel> HebirosModel::parseURDF(const urdf::Model& model)
+bool HebirosModel::parseURDF(const urdf::Model& model, std::vector<Chain>& chains,
+  std::string& base_name)
 {
   const urdf::Link* root = model.getRoot().get();
-  std::unique_ptr<hebi::robot_model::RobotModel> rm(new hebi::robot_model::RobotModel());
+  chains.clear();
+  base_name = root->name;
 
   // Note: in the future, we could support selection of specific child links
   // from the URDF file.
@@ -188,13 +592,233 @@ std::unique_ptr<hebi::robot_model::RobotModel> HebirosModel::parseURDF(const urd
     }
 
     // Set base frame according to this object
-    rm->setBaseFrame(ROSPoseToEigenMatrix(child->parent_joint->parent_to_joint_origin_transform));
+    size_t root_index = addChain(chains, -1,
+      ROSPoseToEigenMatrix(child->parent_joint->parent_to_joint_origin_transform));
 
-    parseInner(*child, *rm.get());
+    parseInner(*child, chains, root_index);
   } catch (const std::exception& e) {
     ROS_ERROR_STREAM(std::string(e.what()));
-    return nullptr;
+    chains.clear();
+    return false;
+  }
+
+  if (chains.size() > 1)
+    ROS_INFO_STREAM("Parsed kinematic tree with " << chains.size() << " chains");
+
+  return true;
+}
+
+bool HebirosModel::buildChains(std::vector<Chain>& chains) {
+
+  // Chains were added depth first, so assigning joints in chain order matches
+  // the depth-first order of joints in the URDF.
+  size_t dof_offset = 0;
+  for (auto& chain : chains) {
+    chain.model.reset(new hebi::robot_model::RobotModel());
+    chain.model->setBaseFrame(fromRowMajor(chain.base_frame));
+
+    for (auto& element : chain.elements) {
+      bool added;
+      if (element.type == Element::Type::RigidBody) {
+        Eigen::VectorXd inertia(6);
+        for (size_t i = 0; i < 6; ++i)
+          inertia[i] = element.inertia[i];
+        added = chain.model->addRigidBody(fromRowMajor(element.com), inertia,
+          element.mass, fromRowMajor(element.output), false);
+      } else {
+        added = chain.model->addJoint(element.joint_type, false);
+      }
+      if (!added) {
+        ROS_ERROR("Could not add element to robot model (e.g., a branch starting with a joint)");
+        return false;
+      }
+    }
+
+    chain.dof_offset = dof_offset;
+    chain.dof_count = chain.model->getDoFCount();
+    dof_offset += chain.dof_count;
+  }
+
+  return !chains.empty();
+}
+
+static const char snapshot_magic[8] = {'H', 'E', 'B', 'I', 'M', 'D', 'L', '\0'};
+static const uint32_t snapshot_version = 4;
+// Written in native byte order; reads back differently on a machine with
+// another byte order
+static const uint32_t snapshot_byte_order = 0x01020304;
+// Upper bound on the chains, elements or capsules of a model, and on the
+// length of a name; anything larger is taken as a corrupt snapshot
+static const uint32_t snapshot_max_count = 1 << 16;
+
+template<typename T>
+static void writeValue(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool readValue(std::istream& in, T& value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+static void writeString(std::ostream& out, const std::string& value) {
+  writeValue(out, static_cast<uint32_t>(value.size()));
+  out.write(value.data(), value.size());
+}
+
+static bool readString(std::istream& in, std::string& value) {
+  uint32_t size;
+  if (!readValue(in, size) || size > snapshot_max_count)
+    return false;
+  value.resize(size);
+  return static_cast<bool>(in.read(&value[0], size));
+}
+
+// True if "count" items of "item_size" bytes are within the count limit and
+// fit in what is left of a file of "file_size" bytes
+static bool snapshotFits(std::istream& in, uint64_t file_size, uint32_t count,
+  size_t item_size) {
+
+  std::streamoff position = in.tellg();
+  if (position < 0 || count > snapshot_max_count)
+    return false;
+  return static_cast<uint64_t>(count) * item_size <= file_size - position;
+}
+
+// Snapshot layout (native byte order; these are not meant to be moved between
+// machines): magic, version, byte order marker, description hash, base name,
+// chain count; then for each chain its parent, base frame, element count, raw
+// element data and element names, capsule count and raw capsule data. Strings
+// are stored as a length followed by the characters. Counts are checked
+// against the file size and element contents against their valid values, so
+// a truncated or corrupt snapshot is rejected rather than trusted.
+bool HebirosModel::readSnapshot(const std::string& file, uint64_t hash,
+  std::vector<Chain>& chains, std::string& base_name) {
+
+  std::ifstream in(file, std::ios::binary | std::ios::ate);
+  if (!in)
+    return false;
+  std::streamoff end = in.tellg();
+  if (end < 0 || !in.seekg(0))
+    return false;
+  uint64_t file_size = end;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t file_hash;
+  uint32_t num_chains;
+  if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 8, snapshot_magic) ||
+    !readValue(in, version) || version != snapshot_version ||
+    !readValue(in, byte_order) || byte_order != snapshot_byte_order ||
+    !readValue(in, file_hash) || file_hash != hash ||
+    !readString(in, base_name) || !readValue(in, num_chains) ||
+    !snapshotFits(in, file_size, num_chains, sizeof(Chain::base_frame))) {
+    return false;
+  }
+
+  chains.clear();
+  for (uint32_t i = 0; i < num_chains; ++i) {
+    if (!readSnapshotChain(in, file_size, i, chains)) {
+      chains.clear();
+      return false;
+    }
+  }
+
+  return !chains.empty();
+}
+
+bool HebirosModel::readSnapshotChain(std::istream& in, uint64_t file_size,
+  uint32_t index, std::vector<Chain>& chains) {
+
+  Chain chain;
+  int32_t parent;
+  uint32_t num_elements;
+  if (!readValue(in, parent) || parent >= static_cast<int32_t>(index) || parent < -1 ||
+    !in.read(reinterpret_cast<char*>(chain.base_frame), sizeof(chain.base_frame)) ||
+    !readValue(in, num_elements) || !snapshotFits(in, file_size, num_elements, sizeof(Element))) {
+    return false;
+  }
+  chain.parent = parent;
+  chain.dof_offset = 0;
+  chain.dof_count = 0;
+  chain.has_children = false;
+  chain.elements.resize(num_elements);
+  if (!in.read(reinterpret_cast<char*>(chain.elements.data()),
+    num_elements * sizeof(Element))) {
+    return false;
+  }
+  for (auto& element : chain.elements) {
+    uint8_t type = static_cast<uint8_t>(element.type);
+    int joint_type = static_cast<int>(element.joint_type);
+    if (type > static_cast<uint8_t>(Element::Type::Joint) ||
+      (element.type == Element::Type::Joint &&
+      (joint_type < HebiJointTypeRotationX || joint_type > HebiJointTypeTranslationZ))) {
+      return false;
+    }
+  }
+
+  chain.element_names.resize(num_elements);
+  for (auto& name : chain.element_names) {
+    if (!readString(in, name))
+      return false;
+  }
+
+  uint32_t num_capsules;
+  if (!readValue(in, num_capsules) ||
+    !snapshotFits(in, file_size, num_capsules, sizeof(Capsule))) {
+    return false;
+  }
+  chain.capsules.resize(num_capsules);
+  if (!in.read(reinterpret_cast<char*>(chain.capsules.data()),
+    num_capsules * sizeof(Capsule))) {
+    return false;
+  }
+  for (auto& capsule : chain.capsules) {
+    if (capsule.element >= num_elements ||
+      chain.elements[capsule.element].type != Element::Type::RigidBody) {
+      return false;
+    }
+  }
+
+  if (parent >= 0)
+    chains[parent].has_children = true;
+  chains.push_back(std::move(chain));
+  return true;
+}
+
+bool HebirosModel::writeSnapshot(const std::string& file, uint64_t hash,
+  const std::vector<Chain>& chains, const std::string& base_name) {
+
+  // Write to a temporary file and move it into place, so a concurrent reader
+  // never sees a partial snapshot.
+  std::string tmp_file = file + ".tmp";
+  {
+    std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+
+    out.write(snapshot_magic, sizeof(snapshot_magic));
+    writeValue(out, snapshot_version);
+    writeValue(out, snapshot_byte_order);
+    writeValue(out, hash);
+    writeString(out, base_name);
+    writeValue(out, static_cast<uint32_t>(chains.size()));
+    for (auto& chain : chains) {
+      writeValue(out, static_cast<int32_t>(chain.parent));
+      out.write(reinterpret_cast<const char*>(chain.base_frame), sizeof(chain.base_frame));
+      writeValue(out, static_cast<uint32_t>(chain.elements.size()));
+      out.write(reinterpret_cast<const char*>(chain.elements.data()),
+        chain.elements.size() * sizeof(Element));
+      for (auto& name : chain.element_names)
+        writeString(out, name);
+      writeValue(out, static_cast<uint32_t>(chain.capsules.size()));
+      out.write(reinterpret_cast<const char*>(chain.capsules.data()),
+        chain.capsules.size() * sizeof(Capsule));
+    }
+    if (!out)
+      return false;
   }
 
-  return rm;
+  return std::rename(tmp_file.c_str(), file.c_str()) == 0;
 }
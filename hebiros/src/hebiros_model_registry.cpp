@@ -0,0 +1,72 @@
+#include "hebiros_model.h"
+
+#include "hebiros.h"
+#include "hebiros_urdf_cache.h"
+
+// The set of loaded models, and loading from the parameter server. These use
+// the node's parameters, so they are kept apart from the rest of HebirosModel,
+// which tools can use without a node.
+
+std::map<std::string, HebirosModel> HebirosModel::models;
+
+bool HebirosModel::load(const std::string& name, const std::string& description_param) {
+
+  std::string description;
+  uint64_t hash;
+  if (!HebirosURDFCache::getDescription(description_param, description, hash))
+    return false;
+
+  // Try a snapshot of this exact description first; this avoids parsing the
+  // URDF at all.
+  std::string snapshot_dir = HebirosParameters::getString("hebiros/model_snapshot_dir");
+  std::string snapshot_file;
+  if (!snapshot_dir.empty())
+    snapshot_file = snapshot_dir + "/" + name + ".hebimodel";
+
+  std::vector<Chain> chains;
+  std::string base_name;
+  bool from_snapshot = !snapshot_file.empty() &&
+    readSnapshot(snapshot_file, hash, chains, base_name);
+  if (from_snapshot) {
+    ROS_INFO_STREAM("Loaded model snapshot from " << snapshot_file);
+  } else {
+    // Try to load:
+    std::shared_ptr<const urdf::Model> model =
+      HebirosURDFCache::get(description_param, description, hash);
+    if (!model)
+      return false;
+
+    if (!parseURDF(*model, chains, base_name))
+      return false;
+  }
+
+  if (!buildChains(chains))
+    return false;
+
+  if (!from_snapshot && !snapshot_file.empty() &&
+    !writeSnapshot(snapshot_file, hash, chains, base_name)) {
+    ROS_WARN_STREAM("Could not write model snapshot to " << snapshot_file);
+  }
+
+  HebirosModel model(std::move(chains), std::move(base_name));
+
+  // Reachability maps are generated offline by hebiros_reachability_map
+  std::string map_dir = HebirosParameters::getString("hebiros/reachability_map_dir");
+  if (!map_dir.empty()) {
+    std::string map_file = map_dir + "/" + name + ".hebimap";
+    std::unique_ptr<HebirosReachabilityMap> map(new HebirosReachabilityMap());
+    if (map->open(map_file) && map->getHeader().dof_count == model.getDoFCount()) {
+      ROS_INFO_STREAM("Loaded reachability map from " << map_file);
+      model.setReachabilityMap(std::move(map));
+    }
+  }
+
+  models.emplace(name, std::move(model));
+  return true;
+}
+
+HebirosModel* HebirosModel::getModel(const std::string& model_name) {
+  if (models.count(model_name) == 0)
+    return nullptr;
+  return &models.at(model_name);
+}
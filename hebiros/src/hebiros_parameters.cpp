@@ -1,30 +1,70 @@
 #include "hebiros_parameters.h"
 
-#include "hebiros.h"
-
+std::shared_ptr<ros::NodeHandle> HebirosParameters::n_ptr;
 
 std::map<std::string, bool> HebirosParameters::bool_parameters_default =
-  {{"use_sim_time", false}};
+  {{"use_sim_time", false},
+   {"hebiros/lockstep", false},
+   {"hebiros/shared_memory", true}};
 std::map<std::string, bool> HebirosParameters::bool_parameters;
 std::map<std::string, int> HebirosParameters::int_parameters_default =
   {{"hebiros/node_frequency", 200},
    {"hebiros/action_frequency", 200},
    {"hebiros/feedback_frequency", 100},
-   {"hebiros/command_lifetime", 100}};
+   {"hebiros/command_lifetime", 100},
+   {"hebiros/model_feedback_decimation", 1},
+   {"hebiros/group_lookup_threads", 4}};
 std::map<std::string, int> HebirosParameters::int_parameters;
+std::map<std::string, double> HebirosParameters::double_parameters_default =
+  {{"hebiros/wrench_filter_cutoff", 20.0},
+   {"hebiros/collision_resolution", 0.01},
+   {"hebiros/collision_mesh_radius", 0.04},
+   {"hebiros/sim_time_step", 0.001},
+   {"hebiros/sim_real_time_factor", 0.0}};
+std::map<std::string, double> HebirosParameters::double_parameters;
+std::map<std::string, std::string> HebirosParameters::string_parameters_default =
+  {{"hebiros/model_snapshot_dir", ""},
+   {"hebiros/reachability_map_dir", ""}};
+std::map<std::string, std::string> HebirosParameters::string_parameters;
+
+void HebirosParameters::setNodeHandle(std::shared_ptr<ros::NodeHandle> n) {
+  n_ptr = n;
+}
 
 void HebirosParameters::setNodeParameters() {
 
+  loadBool("hebiros/lockstep");
+  loadBool("hebiros/shared_memory");
   loadInt("hebiros/node_frequency");
   loadInt("hebiros/action_frequency");
   loadInt("hebiros/feedback_frequency");
   loadInt("hebiros/command_lifetime");
+  loadInt("hebiros/model_feedback_decimation");
+  loadInt("hebiros/group_lookup_threads");
+  loadDouble("hebiros/wrench_filter_cutoff");
+  loadDouble("hebiros/collision_resolution");
+  loadDouble("hebiros/collision_mesh_radius");
+  loadDouble("hebiros/sim_time_step");
+  loadDouble("hebiros/sim_real_time_factor");
+  loadString("hebiros/model_snapshot_dir");
+  loadString("hebiros/reachability_map_dir");
 
   ROS_INFO("Parameters:");
+  ROS_INFO("hebiros/lockstep=%d", getBool("hebiros/lockstep"));
+  ROS_INFO("hebiros/shared_memory=%d", getBool("hebiros/shared_memory"));
   ROS_INFO("hebiros/node_frequency=%d", getInt("hebiros/node_frequency"));
   ROS_INFO("hebiros/action_frequency=%d", getInt("hebiros/action_frequency"));
   ROS_INFO("hebiros/feedback_frequency=%d", getInt("hebiros/feedback_frequency"));
   ROS_INFO("hebiros/command_lifetime=%d", getInt("hebiros/command_lifetime"));
+  ROS_INFO("hebiros/model_feedback_decimation=%d", getInt("hebiros/model_feedback_decimation"));
+  ROS_INFO("hebiros/group_lookup_threads=%d", getInt("hebiros/group_lookup_threads"));
+  ROS_INFO("hebiros/wrench_filter_cutoff=%f", getDouble("hebiros/wrench_filter_cutoff"));
+  ROS_INFO("hebiros/collision_resolution=%f", getDouble("hebiros/collision_resolution"));
+  ROS_INFO("hebiros/collision_mesh_radius=%f", getDouble("hebiros/collision_mesh_radius"));
+  ROS_INFO("hebiros/sim_time_step=%f", getDouble("hebiros/sim_time_step"));
+  ROS_INFO("hebiros/sim_real_time_factor=%f", getDouble("hebiros/sim_real_time_factor"));
+  ROS_INFO("hebiros/model_snapshot_dir=%s", getString("hebiros/model_snapshot_dir").c_str());
+  ROS_INFO("hebiros/reachability_map_dir=%s", getString("hebiros/reachability_map_dir").c_str());
 }
 
 void HebirosParameters::loadBool(std::string name) {
@@ -32,8 +72,11 @@ void HebirosParameters::loadBool(std::string name) {
     bool value;
     bool default_value = bool_parameters_default[name];
 
-    HebirosNode::n_ptr->param<bool>(name, value, default_value);
-    HebirosNode::n_ptr->setParam(name, value);
+    if (!n_ptr) {
+      return;
+    }
+    n_ptr->param<bool>(name, value, default_value);
+    n_ptr->setParam(name, value);
     bool_parameters[name] = value;
   }
 }
@@ -41,7 +84,9 @@ void HebirosParameters::loadBool(std::string name) {
 void HebirosParameters::setBool(std::string name, bool value) {
 
   if (bool_parameters_default.find(name) != bool_parameters_default.end()) {
-    HebirosNode::n_ptr->setParam(name, value);
+    if (n_ptr) {
+      n_ptr->setParam(name, value);
+    }
     bool_parameters[name] = value;
   }
 }
@@ -64,8 +109,11 @@ void HebirosParameters::loadInt(std::string name) {
     int value;
     int default_value = int_parameters_default[name];
 
-    HebirosNode::n_ptr->param<int>(name, value, default_value);
-    HebirosNode::n_ptr->setParam(name, value);
+    if (!n_ptr) {
+      return;
+    }
+    n_ptr->param<int>(name, value, default_value);
+    n_ptr->setParam(name, value);
     int_parameters[name] = value;
   }
 }
@@ -73,7 +121,9 @@ void HebirosParameters::loadInt(std::string name) {
 void HebirosParameters::setInt(std::string name, int value) {
 
   if (int_parameters_default.find(name) != int_parameters_default.end()) {
-    HebirosNode::n_ptr->setParam(name, value);
+    if (n_ptr) {
+      n_ptr->setParam(name, value);
+    }
     int_parameters[name] = value;
   }
 }
@@ -90,3 +140,77 @@ int HebirosParameters::getInt(std::string name) {
     return 0;
   }
 }
+
+void HebirosParameters::loadDouble(std::string name) {
+  if (double_parameters_default.find(name) != double_parameters_default.end()) {
+    double value;
+    double default_value = double_parameters_default[name];
+
+    if (!n_ptr) {
+      return;
+    }
+    n_ptr->param<double>(name, value, default_value);
+    n_ptr->setParam(name, value);
+    double_parameters[name] = value;
+  }
+}
+
+void HebirosParameters::setDouble(std::string name, double value) {
+
+  if (double_parameters_default.find(name) != double_parameters_default.end()) {
+    if (n_ptr) {
+      n_ptr->setParam(name, value);
+    }
+    double_parameters[name] = value;
+  }
+}
+
+double HebirosParameters::getDouble(std::string name) {
+
+  if (double_parameters.find(name) != double_parameters.end()) {
+    return double_parameters[name];
+  }
+  else if (double_parameters_default.find(name) != double_parameters_default.end()) {
+    return double_parameters_default[name];
+  }
+  else {
+    return 0;
+  }
+}
+
+void HebirosParameters::loadString(std::string name) {
+  if (string_parameters_default.find(name) != string_parameters_default.end()) {
+    std::string value;
+    std::string default_value = string_parameters_default[name];
+
+    if (!n_ptr) {
+      return;
+    }
+    n_ptr->param<std::string>(name, value, default_value);
+    n_ptr->setParam(name, value);
+    string_parameters[name] = value;
+  }
+}
+
+void HebirosParameters::setString(std::string name, std::string value) {
+
+  if (string_parameters_default.find(name) != string_parameters_default.end()) {
+    if (n_ptr) {
+      n_ptr->setParam(name, value);
+    }
+    string_parameters[name] = value;
+  }
+}
+
+std::string HebirosParameters::getString(std::string name) {
+
+  if (string_parameters.find(name) != string_parameters.end()) {
+    return string_parameters[name];
+  }
+  else if (string_parameters_default.find(name) != string_parameters_default.end()) {
+    return string_parameters_default[name];
+  }
+  else {
+    return "";
+  }
+}
@@ -21,38 +21,93 @@ void HebirosPublishers::registerGroupPublishers(std::string group_name) {
     HebirosNode::n_ptr->advertise<sensor_msgs::JointState>(
     "hebiros/"+group_name+"/feedback/joint_state_urdf", 100);
 
+  publishers["hebiros/"+group_name+"/feedback/end_effector_pose"] =
+    HebirosNode::n_ptr->advertise<geometry_msgs::PoseStamped>(
+    "hebiros/"+group_name+"/feedback/end_effector_pose", 100);
+
+  publishers["hebiros/"+group_name+"/feedback/end_effector_wrench"] =
+    HebirosNode::n_ptr->advertise<geometry_msgs::WrenchStamped>(
+    "hebiros/"+group_name+"/feedback/end_effector_wrench", 100);
+
+  // Shared by all groups
+  if (publishers.find("tf") == publishers.end()) {
+    publishers["tf"] = HebirosNode::n_ptr->advertise<tf2_msgs::TFMessage>("/tf", 100);
+  }
+
   publishers["hebiros/"+group_name+"/command/joint_state"] =
     HebirosNode::n_ptr->advertise<sensor_msgs::JointState>(
     "hebiros/"+group_name+"/command/joint_state", 100);
 }
 
 
-void HebirosPublishers::feedback(FeedbackMsg feedback_msg, std::string group_name) {
+void HebirosPublishers::feedback(const FeedbackMsg& feedback_msg, std::string group_name) {
   publishers["hebiros/"+group_name+"/feedback"].publish(feedback_msg);
 }
 
-void HebirosPublishers::feedbackJointState(sensor_msgs::JointState joint_state_msg,
+void HebirosPublishers::feedback(const boost::shared_ptr<FeedbackMsg const>& feedback_msg,
+  std::string group_name) {
+  publishers["hebiros/"+group_name+"/feedback"].publish(feedback_msg);
+}
+
+void HebirosPublishers::feedbackJointState(const sensor_msgs::JointState& joint_state_msg,
   std::string group_name) {
   publishers["hebiros/"+group_name+"/feedback/joint_state"].publish(joint_state_msg);
 
   feedbackJointStateUrdf(joint_state_msg, group_name);
 }
 
-void HebirosPublishers::feedbackJointStateUrdf(sensor_msgs::JointState joint_state_msg,
+void HebirosPublishers::feedbackJointStateUrdf(const sensor_msgs::JointState& joint_state_msg,
   std::string group_name) {
 
   HebirosGroup* group = HebirosGroupRegistry::Instance().getGroup(group_name);
 
   if (joint_state_msg.name.size() == group->joint_full_names.size()) {
-    for (int i = 0; i < group->joint_full_names.size(); i++) {
-      joint_state_msg.name[i] = group->joint_full_names[joint_state_msg.name[i]];
+    sensor_msgs::JointState& urdf_msg = group->joint_state_urdf_msg;
+    urdf_msg.header = joint_state_msg.header;
+    urdf_msg.name.resize(joint_state_msg.name.size());
+    for (int i = 0; i < joint_state_msg.name.size(); i++) {
+      urdf_msg.name[i] = group->joint_full_names[joint_state_msg.name[i]];
     }
+    urdf_msg.position = joint_state_msg.position;
+    urdf_msg.velocity = joint_state_msg.velocity;
+    urdf_msg.effort = joint_state_msg.effort;
 
-    publishers["hebiros/"+group_name+"/feedback/joint_state_urdf"].publish(joint_state_msg);
+    publishers["hebiros/"+group_name+"/feedback/joint_state_urdf"].publish(urdf_msg);
   }
 }
 
-void HebirosPublishers::commandJointState(sensor_msgs::JointState joint_state_msg,
+void HebirosPublishers::feedbackModel(const FeedbackMsg& feedback_msg,
+  std::string group_name) {
+
+  HebirosGroup* group = HebirosGroupRegistry::Instance().getGroup(group_name);
+
+  std::lock_guard<std::mutex> lock(group->model_mutex);
+  HebirosGroupModel* model = group->model.get();
+  if (!model || !model->setPositions(feedback_msg))
+    return;
+
+  ros::Time stamp = ros::Time::now();
+
+  // The wrench estimate is only computed when someone listens. With gravity
+  // compensation, the gravity efforts for this feedback were already computed
+  // when the command was sent.
+  ros::Publisher& wrench_publisher =
+    publishers["hebiros/"+group_name+"/feedback/end_effector_wrench"];
+  if (wrench_publisher.getNumSubscribers() > 0 &&
+    (model->getGravityCompensation() || model->updateGravityEfforts(feedback_msg)) &&
+    model->updateWrench(feedback_msg, stamp)) {
+    wrench_publisher.publish(model->wrench_msg);
+  }
+
+  if (!model->updateFrames(stamp))
+    return;
+
+  publishers["tf"].publish(model->tf_msg);
+  publishers["hebiros/"+group_name+"/feedback/end_effector_pose"].publish(
+    model->end_effector_msg);
+}
+
+void HebirosPublishers::commandJointState(const sensor_msgs::JointState& joint_state_msg,
   std::string group_name) {
   publishers["hebiros/"+group_name+"/command/joint_state"].publish(joint_state_msg);
 }
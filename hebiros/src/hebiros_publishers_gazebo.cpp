@@ -1,6 +1,7 @@
 #include "hebiros_publishers_gazebo.h"
 
 #include "hebiros.h"
+#include "hebiros_group_registry.h"
 
 using namespace hebiros;
 
@@ -14,8 +15,95 @@ void HebirosPublishersGazebo::registerGroupPublishers(std::string group_name) {
   HebirosPublishers::registerGroupPublishers(group_name);
 }
 
-void HebirosPublishersGazebo::command(CommandMsg command_msg, std::string group_name) {
+void HebirosPublishersGazebo::command(const CommandMsg& command_msg,
+  std::string group_name) {
+
+  if (HebirosParameters::getBool("hebiros/lockstep")) {
+    std::lock_guard<std::mutex> lock(lockstep_mutex);
+    lockstep_commands[group_name] = boost::make_shared<CommandMsg>(command_msg);
+    return;
+  }
+
+  publishCommand(command_msg, group_name);
+}
+
+void HebirosPublishersGazebo::command(const boost::shared_ptr<CommandMsg const>& command_msg,
+  std::string group_name) {
+
+  if (HebirosParameters::getBool("hebiros/lockstep")) {
+    std::lock_guard<std::mutex> lock(lockstep_mutex);
+    lockstep_commands[group_name] = command_msg;
+    return;
+  }
+
+  publishCommand(command_msg, group_name);
+}
+
+void HebirosPublishersGazebo::publishCommand(const CommandMsg& command_msg,
+  std::string group_name) {
+
+  if (HebirosNode::use_sim) {
+    HebirosGroupSim* group = dynamic_cast<HebirosGroupSim*>(
+      HebirosGroupRegistry::Instance().getGroup(group_name));
+    if (group) {
+      group->setCommand(command_msg, ros::Time::now());
+    }
+    return;
+  }
+
+  if (HebirosNode::shm_transport.sendCommand(command_msg, group_name)) {
+    return;
+  }
 
   publishers["hebiros_gazebo_plugin/command/"+group_name].publish(command_msg);
 }
 
+void HebirosPublishersGazebo::publishCommand(
+  const boost::shared_ptr<CommandMsg const>& command_msg, std::string group_name) {
+
+  if (HebirosNode::use_sim) {
+    publishCommand(*command_msg, group_name);
+    return;
+  }
+
+  if (HebirosNode::shm_transport.sendCommand(*command_msg, group_name)) {
+    return;
+  }
+
+  publishers["hebiros_gazebo_plugin/command/"+group_name].publish(command_msg);
+}
+
+static bool hasGains(const PidGainsMsg& gains) {
+  return !gains.name.empty() || !gains.kp.empty() || !gains.ki.empty() || !gains.kd.empty() ||
+    !gains.feed_forward.empty() || !gains.dead_zone.empty() || !gains.i_clamp.empty() ||
+    !gains.punch.empty() || !gains.min_target.empty() || !gains.max_target.empty() ||
+    !gains.target_lowpass.empty() || !gains.min_output.empty() || !gains.max_output.empty() ||
+    !gains.output_lowpass.empty() || !gains.d_on_error.empty();
+}
+
+static bool hasSettings(const SettingsMsg& settings) {
+  return !settings.name.empty() || !settings.save_current_settings.empty() ||
+    !settings.control_strategy.empty() || hasGains(settings.position_gains) ||
+    hasGains(settings.velocity_gains) || hasGains(settings.effort_gains);
+}
+
+//In lockstep mode, the simulator waits for one command after each feedback
+//once a group has been commanded; send the latest command, which may be the
+//same as the last one. Settings are only sent once; repeats of a command only
+//carry its setpoints, so the simulator does not apply the settings again.
+void HebirosPublishersGazebo::stepCommand(std::string group_name) {
+
+  std::lock_guard<std::mutex> lock(lockstep_mutex);
+  auto command = lockstep_commands.find(group_name);
+  if (command == lockstep_commands.end()) {
+    return;
+  }
+  publishCommand(command->second, group_name);
+
+  //The held message may be shared with its subscription, so replace it
+  if (hasSettings(command->second->settings)) {
+    boost::shared_ptr<CommandMsg> setpoints = boost::make_shared<CommandMsg>(*command->second);
+    setpoints->settings = SettingsMsg();
+    command->second = setpoints;
+  }
+}
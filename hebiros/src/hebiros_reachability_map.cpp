@@ -0,0 +1,121 @@
+#include "hebiros_reachability_map.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char map_magic[8] = {'H', 'E', 'B', 'I', 'R', 'M', 'A', 'P'};
+static const uint32_t map_version = 1;
+
+HebirosReachabilityMap::HebirosReachabilityMap()
+ : data(nullptr), data_size(0), header(nullptr), voxels(nullptr) {
+}
+
+HebirosReachabilityMap::~HebirosReachabilityMap() {
+  close();
+}
+
+void HebirosReachabilityMap::close() {
+  if (data)
+    munmap(data, data_size);
+  data = nullptr;
+  data_size = 0;
+  header = nullptr;
+  voxels = nullptr;
+}
+
+bool HebirosReachabilityMap::open(const std::string& file) {
+  close();
+
+  int fd = ::open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(Header))) {
+    ::close(fd);
+    return false;
+  }
+
+  void* mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED)
+    return false;
+
+  data = mapped;
+  data_size = file_stat.st_size;
+  header = static_cast<const Header*>(data);
+
+  // The header is untrusted: its sizes are multiplied only while the product
+  // still fits in the file, and the grid has to be finite.
+  uint64_t max_voxels = (data_size - sizeof(Header)) / sizeof(Voxel);
+  uint64_t voxel_count = 1;
+  bool sizes_fit = true;
+  for (size_t i = 0; i < 3; ++i) {
+    if (header->size[i] != 0 && voxel_count > max_voxels / header->size[i])
+      sizes_fit = false;
+    else
+      voxel_count *= header->size[i];
+  }
+  bool finite = std::isfinite(header->voxel_size) && std::isfinite(header->origin[0]) &&
+    std::isfinite(header->origin[1]) && std::isfinite(header->origin[2]);
+  if (std::memcmp(header->magic, map_magic, sizeof(map_magic)) != 0 ||
+    header->version != map_version || !finite || header->voxel_size <= 0 || !sizes_fit ||
+    data_size != sizeof(Header) + voxel_count * sizeof(Voxel)) {
+    close();
+    return false;
+  }
+
+  voxels = reinterpret_cast<const Voxel*>(static_cast<const char*>(data) + sizeof(Header));
+  return true;
+}
+
+const HebirosReachabilityMap::Header& HebirosReachabilityMap::getHeader() const {
+  return *header;
+}
+
+const HebirosReachabilityMap::Voxel* HebirosReachabilityMap::lookup(
+  const Eigen::Vector3d& position) const {
+
+  if (!voxels)
+    return nullptr;
+
+  size_t index = 0;
+  size_t stride = 1;
+  for (size_t i = 0; i < 3; ++i) {
+    double cell = std::floor((position[i] - header->origin[i]) / header->voxel_size);
+    if (!std::isfinite(cell) || cell < 0 || cell >= header->size[i])
+      return nullptr;
+    index += static_cast<size_t>(cell) * stride;
+    stride *= header->size[i];
+  }
+  return &voxels[index];
+}
+
+bool HebirosReachabilityMap::write(const std::string& file, Header header,
+  const std::vector<Voxel>& voxels) {
+
+  std::memcpy(header.magic, map_magic, sizeof(map_magic));
+  header.version = map_version;
+
+  // Write to a temporary file and move it into place, so a node never maps a
+  // partial file.
+  std::string tmp_file = file + ".tmp";
+  {
+    std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(voxels.data()), voxels.size() * sizeof(Voxel));
+    if (!out)
+      return false;
+  }
+
+  return std::rename(tmp_file.c_str(), file.c_str()) == 0;
+}
@@ -12,6 +12,20 @@ void HebirosServices::registerModelServices(const std::string& model_name) {
     HebirosNode::n_ptr->advertiseService<ModelFkSrv::Request, ModelFkSrv::Response>(
     "hebiros/"+model_name+"/fk",
     boost::bind(&HebirosServices::fk, this, _1, _2, model_name));
+
+  services["hebiros/"+model_name+"/ik"] =
+    HebirosNode::n_ptr->advertiseService<ModelIkSrv::Request, ModelIkSrv::Response>(
+    "hebiros/"+model_name+"/ik",
+    boost::bind(&HebirosServices::ik, this, _1, _2, model_name));
+
+  HebirosModel* model = HebirosModel::getModel(model_name);
+  if (model && model->getReachabilityMap()) {
+    services["hebiros/"+model_name+"/reachable"] =
+      HebirosNode::n_ptr->advertiseService<ModelReachableSrv::Request,
+      ModelReachableSrv::Response>(
+      "hebiros/"+model_name+"/reachable",
+      boost::bind(&HebirosServices::reachable, this, _1, _2, model_name));
+  }
 }
 
 bool HebirosServices::entryList(
@@ -69,6 +83,41 @@ bool HebirosServices::addGroupFromURDF(
   return true;
 }
 
+bool HebirosServices::setModel(
+  SetModelSrv::Request &req, SetModelSrv::Response &res, std::string group_name) {
+
+  HebirosGroup* group = HebirosGroupRegistry::Instance().getGroup(group_name);
+  if (!group) {
+    ROS_WARN("hebiros/%s not found; could not set model", group_name.c_str());
+    return false;
+  }
+
+  std::unique_ptr<HebirosGroupModel> group_model;
+  if (!req.model_name.empty()) {
+    HebirosModel* model = HebirosModel::getModel(req.model_name);
+    if (!model) {
+      ROS_WARN("Model [%s] not found", req.model_name.c_str());
+      return false;
+    }
+
+    group_model.reset(new HebirosGroupModel(*model, *group));
+    if (!group_model->isValid()) {
+      ROS_WARN("Joints of model [%s] do not match group [%s]",
+        req.model_name.c_str(), group_name.c_str());
+      return false;
+    }
+    group_model->setGravityCompensation(req.gravity_compensation);
+  }
+
+  std::lock_guard<std::mutex> lock(group->model_mutex);
+  group->model = std::move(group_model);
+
+  ROS_INFO("hebiros/%s model=%s gravity_compensation=%d", group_name.c_str(),
+    req.model_name.c_str(), req.gravity_compensation);
+
+  return true;
+}
+
 bool HebirosServices::split(const std::string &orig, std::string &name, std::string &family) {
   std::stringstream ss(orig);
 
@@ -109,7 +158,7 @@ bool HebirosServices::addModelFromURDF(
   static const std::string default_desc("robot_description");
   auto& description_param = req.description_param.size() == 0 ? default_desc : req.description_param;
 
-  if (HebirosModel::load(req.model_name, req.description_param)) {
+  if (HebirosModel::load(req.model_name, description_param)) {
     registerModelServices(req.model_name);
     return true;
   }
@@ -169,18 +218,20 @@ bool HebirosServices::fk(ModelFkSrv::Request& req, ModelFkSrv::Response& res, co
   // Convert ROS message into HEBI types
   HebiFrameType frame_type = HebiFrameTypeOutput;
   if (req.frame_type == ModelFkSrv::Request::FrameTypeCenterOfMass)
-    frame_type == HebiFrameTypeCenterOfMass;
+    frame_type = HebiFrameTypeCenterOfMass;
   else if (req.frame_type == ModelFkSrv::Request::FrameTypeOutput)
-    frame_type == HebiFrameTypeOutput;
+    frame_type = HebiFrameTypeOutput;
   else
     return false; // Invalid frame type!
+  if (req.positions.size() != model->getDoFCount())
+    return false;
   Eigen::VectorXd joints(req.positions.size());
   for (size_t i = 0; i < joints.size(); ++i)
     joints[i] = req.positions[i];
  
-  // Get the frames from the robot model 
+  // Get the frames from the robot model (all branches, for trees)
   hebi::robot_model::Matrix4dVector frames;
-  model->getModel().getFK(HebiFrameTypeOutput, joints, frames);
+  model->getFK(frame_type, joints, frames);
 
   // Fill in the ROS messages
   res.frames.resize(frames.size() * 16);
@@ -194,3 +245,61 @@ bool HebirosServices::fk(ModelFkSrv::Request& req, ModelFkSrv::Response& res, co
 
   return true;
 }
+
+bool HebirosServices::ik(ModelIkSrv::Request& req, ModelIkSrv::Response& res,
+  const std::string& model_name) {
+
+  auto model = HebirosModel::getModel(model_name);
+  if (!model)
+    return false;
+  if (req.target.size() != 16 || req.initial_positions.size() != model->getDoFCount())
+    return false;
+
+  Eigen::Matrix4d target;
+  for (size_t j = 0; j < 4; ++j) {
+    for (size_t k = 0; k < 4; ++k) {
+      target(j, k) = req.target[j * 4 + k];
+    }
+  }
+  Eigen::VectorXd initial_positions(req.initial_positions.size());
+  for (size_t i = 0; i < initial_positions.size(); ++i)
+    initial_positions[i] = req.initial_positions[i];
+
+  res.solution_count = 0;
+  res.analytic = false;
+
+  // Positions that the end effector never reached when the reachability map
+  // was generated have no solutions; skip the solver.
+  auto map = model->getReachabilityMap();
+  if (map) {
+    auto voxel = map->lookup(target.topRightCorner<3,1>());
+    if (!voxel || voxel->count == 0)
+      return true;
+  }
+
+  std::vector<Eigen::VectorXd> solutions;
+  bool analytic;
+  if (!model->solveIK(target, initial_positions, solutions, analytic))
+    return false;
+
+  res.solution_count = solutions.size();
+  res.analytic = analytic;
+  for (auto& solution : solutions)
+    res.positions.insert(res.positions.end(), solution.data(), solution.data() + solution.size());
+
+  return true;
+}
+
+bool HebirosServices::reachable(ModelReachableSrv::Request& req,
+  ModelReachableSrv::Response& res, const std::string& model_name) {
+
+  auto model = HebirosModel::getModel(model_name);
+  if (!model || !model->getReachabilityMap())
+    return false;
+
+  auto voxel = model->getReachabilityMap()->lookup(Eigen::Vector3d(req.x, req.y, req.z));
+  res.reachable = voxel && voxel->count > 0;
+  res.manipulability = voxel ? voxel->manipulability : 0;
+
+  return true;
+}
@@ -43,6 +43,11 @@ void HebirosServicesGazebo::registerGroupServices(std::string group_name) {
     SendCommandWithAcknowledgementSrv::Response>(
     "hebiros/"+group_name+"/send_command_with_acknowledgement",
     boost::bind(&HebirosServicesGazebo::sendCommandWithAcknowledgement, this, _1, _2, group_name));
+
+  services["hebiros/"+group_name+"/set_model"] =
+    HebirosNode::n_ptr->advertiseService<SetModelSrv::Request, SetModelSrv::Response>(
+    "hebiros/"+group_name+"/set_model",
+    boost::bind(&HebirosServices::setModel, this, _1, _2, group_name));
 }
 
 bool HebirosServicesGazebo::entryList(
@@ -63,7 +68,8 @@ bool HebirosServicesGazebo::addGroup(
     return true;
   }
   
-  std::unique_ptr<HebirosGroupGazebo> group(new HebirosGroupGazebo());
+  std::unique_ptr<HebirosGroupGazebo> group(HebirosNode::use_sim ?
+    new HebirosGroupSim() : new HebirosGroupGazebo());
 
   if (!HebirosServices::addGroup(req, res, joint_full_names, std::move(group))) {
     return false;
@@ -73,8 +79,21 @@ bool HebirosServicesGazebo::addGroup(
   HebirosNode::publishers_gazebo.registerGroupPublishers(req.group_name);
   HebirosNode::subscribers_gazebo.registerGroupSubscribers(req.group_name);
   HebirosNode::actions.registerGroupActions(req.group_name);
-  HebirosNode::clients.registerGroupClients(req.group_name);
-  HebirosNode::clients.addGroup(req);
+
+  if (HebirosNode::use_sim) {
+    static_cast<HebirosGroupSim*>(registry.getGroup(req.group_name))->initialize();
+  }
+  else {
+    HebirosNode::clients.registerGroupClients(req.group_name);
+    HebirosNode::clients.addGroup(req);
+
+    // The plugin creates the group's shared memory rings while adding it, if
+    // it runs on this host
+    if (HebirosParameters::getBool("hebiros/shared_memory") &&
+      HebirosNode::shm_transport.attach(req.group_name)) {
+      ROS_INFO("Group [%s] uses shared memory", req.group_name.c_str());
+    }
+  }
 
   return true;
 }
@@ -91,8 +110,8 @@ bool HebirosServicesGazebo::addGroupFromURDF(
   AddGroupFromURDFSrv::Request &req, AddGroupFromURDFSrv::Response &res) {
 
   std::string urdf_name("robot_description");
-  urdf::Model urdf_model;
-  if (!urdf_model.initParam(urdf_name))
+  std::shared_ptr<const urdf::Model> urdf_model = HebirosURDFCache::get(urdf_name);
+  if (!urdf_model)
   {
     ROS_WARN("Could not load robot_description");
     return false;
@@ -106,7 +125,7 @@ bool HebirosServicesGazebo::addGroupFromURDF(
   std::map<std::string, std::string> joint_full_names;
 
   HebirosServices::addJointChildren(joint_names, family_names, joint_full_names,
-    urdf_model.getRoot().get());
+    urdf_model->getRoot().get());
 
   AddGroupFromNamesSrv::Request names_req;
   AddGroupFromNamesSrv::Response names_res;
@@ -135,7 +154,15 @@ bool HebirosServicesGazebo::setFeedbackFrequency(
   SetFeedbackFrequencySrv::Request &req, SetFeedbackFrequencySrv::Response &res,
   std::string group_name) {
 
-  HebirosNode::clients.setFeedbackFrequency(req, group_name);
+  if (HebirosNode::use_sim) {
+    HebirosGroup* group = HebirosGroupRegistry::Instance().getGroup(group_name);
+    if (group) {
+      group->setFeedbackFrequency(req.feedback_frequency);
+    }
+  }
+  else {
+    HebirosNode::clients.setFeedbackFrequency(req, group_name);
+  }
 
   HebirosServices::setFeedbackFrequency(req, res, group_name);
 
@@ -146,7 +173,15 @@ bool HebirosServicesGazebo::setCommandLifetime(
   SetCommandLifetimeSrv::Request &req, SetCommandLifetimeSrv::Response &res,
   std::string group_name) {
 
-  HebirosNode::clients.setCommandLifetime(req, group_name);
+  if (HebirosNode::use_sim) {
+    HebirosGroup* group = HebirosGroupRegistry::Instance().getGroup(group_name);
+    if (group) {
+      group->setCommandLifetime(req.command_lifetime);
+    }
+  }
+  else {
+    HebirosNode::clients.setCommandLifetime(req, group_name);
+  }
 
   HebirosServices::setCommandLifetime(req, res, group_name);
 
@@ -157,10 +192,19 @@ bool HebirosServicesGazebo::sendCommandWithAcknowledgement(
   SendCommandWithAcknowledgementSrv::Request &req, 
   SendCommandWithAcknowledgementSrv::Response &res, std::string group_name) {
     
+  // The built-in simulator takes commands directly, so there is nothing to
+  // acknowledge
+  if (HebirosNode::use_sim) {
+    HebirosNode::publishers_gazebo.publishCommand(req.command, group_name);
+    return true;
+  }
+
   std_srvs::Empty empty_srv;
 
+  // Publish directly even in lockstep mode: feedback is not handled while
+  // this service runs, so the command would never be stepped out.
   while(!HebirosNode::clients.acknowledge(empty_srv.request, group_name)) {
-    HebirosNode::publishers_gazebo.command(req.command, group_name);
+    HebirosNode::publishers_gazebo.publishCommand(req.command, group_name);
   }
 
   return true;
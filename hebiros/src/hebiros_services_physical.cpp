@@ -43,6 +43,11 @@ void HebirosServicesPhysical::registerGroupServices(std::string group_name) {
     SendCommandWithAcknowledgementSrv::Response>(
     "hebiros/"+group_name+"/send_command_with_acknowledgement",
     boost::bind(&HebirosServicesPhysical::sendCommandWithAcknowledgement, this, _1, _2, group_name));
+
+  services["hebiros/"+group_name+"/set_model"] =
+    HebirosNode::n_ptr->advertiseService<SetModelSrv::Request, SetModelSrv::Response>(
+    "hebiros/"+group_name+"/set_model",
+    boost::bind(&HebirosServices::setModel, this, _1, _2, group_name));
 }
 
 bool HebirosServicesPhysical::entryList(
@@ -51,6 +56,13 @@ bool HebirosServicesPhysical::entryList(
   EntryListMsg entry_list_msg;
   EntryMsg entry_msg;
 
+  // Imitation groups are not backed by modules on the network
+  if (HebirosNode::use_imitation) {
+    entry_list_msg.size = 0;
+    res.entry_list = entry_list_msg;
+    return true;
+  }
+
   std::shared_ptr<Lookup::EntryList> entry_list = lookup.getEntryList();
   entry_list_msg.size = entry_list->size();
 
@@ -83,7 +95,27 @@ bool HebirosServicesPhysical::addGroup(
     return true;
   }
 
-  std::shared_ptr<hebi::Group> group_ptr = lookup.getGroupFromNames(req.families, req.names);
+  if (req.families.size() != 1 && req.families.size() != req.names.size()) {
+    ROS_WARN("Invalid number of familes for group [%s]", req.group_name.c_str());
+    return false;
+  }
+
+  return registerGroup(req, res, joint_full_names, lookupGroup(req));
+}
+
+std::shared_ptr<hebi::Group> HebirosServicesPhysical::lookupGroup(
+  const AddGroupFromNamesSrv::Request &req) {
+
+  if (HebirosNode::use_imitation) {
+    return hebi::Group::createImitation(req.names.size());
+  }
+  return lookup.getGroupFromNames(req.families, req.names);
+}
+
+bool HebirosServicesPhysical::registerGroup(
+  AddGroupFromNamesSrv::Request &req, AddGroupFromNamesSrv::Response &res,
+  const std::map<std::string, std::string>& joint_full_names,
+  std::shared_ptr<hebi::Group> group_ptr) {
 
   if (!group_ptr) {
 
@@ -117,31 +149,38 @@ bool HebirosServicesPhysical::addGroupFromNames(
 bool HebirosServicesPhysical::addGroupFromURDF(
   AddGroupFromURDFSrv::Request &req, AddGroupFromURDFSrv::Response &res) {
 
-  std::string urdf_name("robot_description");
-  urdf::Model urdf_model;
-  if (!urdf_model.initParam(urdf_name))
-  {
-    ROS_WARN("Could not load robot_description");
+  AddGroupFromNamesSrv::Request names_req;
+  AddGroupFromNamesSrv::Response names_res;
+  std::map<std::string, std::string> joint_full_names;
+  names_req.group_name = req.group_name;
+
+  if (!namesFromURDF("robot_description", names_req, joint_full_names)) {
     return false;
   }
-  else {
-    HebirosServices::addGroupFromURDF(req, res);
+  HebirosServices::addGroupFromURDF(req, res);
+
+  return HebirosNode::services_physical.addGroup(names_req, names_res, joint_full_names);
+}
+
+bool HebirosServicesPhysical::namesFromURDF(const std::string& description_param,
+  AddGroupFromNamesSrv::Request &names_req, std::map<std::string, std::string>& joint_full_names) {
+
+  std::shared_ptr<const urdf::Model> urdf_model = HebirosURDFCache::get(description_param);
+  if (!urdf_model)
+  {
+    ROS_WARN("Could not load %s", description_param.c_str());
+    return false;
   }
 
   std::set<std::string> joint_names;
   std::set<std::string> family_names;
-  std::map<std::string, std::string> joint_full_names;
 
   HebirosServices::addJointChildren(joint_names, family_names, joint_full_names,
-    urdf_model.getRoot().get());
-
-  AddGroupFromNamesSrv::Request names_req;
-  AddGroupFromNamesSrv::Response names_res;
-  names_req.group_name = req.group_name;
-  names_req.families.insert(names_req.families.end(), family_names.begin(), family_names.end());
-  names_req.names.insert(names_req.names.end(), joint_names.begin(), joint_names.end());
+    urdf_model->getRoot().get());
 
-  return HebirosNode::services_physical.addGroup(names_req, names_res, joint_full_names);
+  names_req.families.assign(family_names.begin(), family_names.end());
+  names_req.names.assign(joint_names.begin(), joint_names.end());
+  return true;
 }
 
 bool HebirosServicesPhysical::addModelFromURDF(
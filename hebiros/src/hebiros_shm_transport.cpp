@@ -0,0 +1,117 @@
+#include "hebiros_shm_transport.h"
+
+#include "ros/callback_queue.h"
+
+#include "hebiros.h"
+
+using namespace hebiros;
+using hebiros::sim::ShmRing;
+
+// How long the receiving thread sleeps when no ring had new feedback
+static constexpr std::chrono::microseconds poll_period {20};
+
+// Runs the feedback handler on the node's callback queue, as a subscription
+// callback would
+class ShmFeedbackCallback : public ros::CallbackInterface {
+
+  public:
+
+    ShmFeedbackCallback(boost::shared_ptr<FeedbackMsg const> feedback_msg,
+      const std::string& group_name) :
+      feedback_msg(feedback_msg), group_name(group_name) {}
+
+    CallResult call() override {
+      HebirosNode::subscribers_gazebo.feedback(feedback_msg, group_name);
+      return Success;
+    }
+
+  private:
+
+    boost::shared_ptr<FeedbackMsg const> feedback_msg;
+    std::string group_name;
+};
+
+HebirosShmTransport::~HebirosShmTransport() {
+  stop();
+}
+
+bool HebirosShmTransport::attach(std::string group_name) {
+
+  Rings rings;
+  rings.command = ShmRing::open(ShmRing::nameForTopic(
+    HebirosNode::n_ptr->resolveName("hebiros_gazebo_plugin/command/"+group_name)));
+  rings.feedback = ShmRing::open(ShmRing::nameForTopic(
+    HebirosNode::n_ptr->resolveName("hebiros_gazebo_plugin/feedback/"+group_name)));
+
+  if (!rings.command || !rings.feedback) {
+    return false;
+  }
+  rings.feedback->attachReader(true);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    groups[group_name] = std::move(rings);
+  }
+
+  if (!running.exchange(true)) {
+    thread = std::thread(&HebirosShmTransport::receive, this);
+  }
+  return true;
+}
+
+bool HebirosShmTransport::sendCommand(const CommandMsg& command_msg,
+  std::string group_name) {
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto group = groups.find(group_name);
+  if (group == groups.end() || group->second.command_fallback) {
+    return false;
+  }
+
+  //A command published while earlier ones wait in the ring could be applied
+  //before them, so stay on the topic from then on
+  Rings& rings = group->second;
+  if (!rings.command->hasReader() || !rings.command->write(command_msg)) {
+    ROS_WARN("Could not write a command of group %s to shared memory; publishing its "
+      "commands from now on", group_name.c_str());
+    rings.command_fallback = true;
+    return false;
+  }
+  return true;
+}
+
+void HebirosShmTransport::stop() {
+
+  if (running.exchange(false)) {
+    thread.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto& group : groups) {
+    group.second.feedback->attachReader(false);
+  }
+  groups.clear();
+}
+
+void HebirosShmTransport::receive() {
+
+  boost::shared_ptr<FeedbackMsg> feedback_msg = boost::make_shared<FeedbackMsg>();
+
+  while (running) {
+    bool received = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto& group : groups) {
+        while (group.second.feedback->read(*feedback_msg)) {
+          ros::getGlobalCallbackQueue()->addCallback(
+            boost::make_shared<ShmFeedbackCallback>(feedback_msg, group.first));
+          feedback_msg = boost::make_shared<FeedbackMsg>();
+          received = true;
+        }
+      }
+    }
+    if (!received) {
+      std::this_thread::sleep_for(poll_period);
+    }
+  }
+}
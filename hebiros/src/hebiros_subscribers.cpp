@@ -13,6 +13,68 @@ bool HebirosSubscribers::jointFound(std::string group_name, std::string joint_na
   return group->joints.find(joint_name) != group->joints.end();
 }
 
+// Commands to groups with gravity compensation are held by the group's model
+// and sent along with the compensation on the next feedback.
+bool HebirosSubscribers::holdCommand(std::string group_name,
+  const sensor_msgs::JointState& data, const hebiros::SettingsMsg* settings_data) {
+
+  HebirosGroup* group = hebiros::HebirosGroupRegistry::Instance().getGroup(group_name);
+
+  std::lock_guard<std::mutex> lock(group->model_mutex);
+  return group->model && group->model->setCommand(data, settings_data);
+}
+
+bool HebirosSubscribers::holdCommand(std::string group_name,
+  const hebiros::CommandMsg& data) {
+
+  HebirosGroup* group = hebiros::HebirosGroupRegistry::Instance().getGroup(group_name);
+
+  std::lock_guard<std::mutex> lock(group->model_mutex);
+  if (!group->model) {
+    return false;
+  }
+
+  sensor_msgs::JointState joint_data;
+  joint_data.name = data.name;
+  joint_data.position = data.position;
+  joint_data.velocity = data.velocity;
+  joint_data.effort = data.effort;
+  return group->model->setCommand(joint_data, &data.settings);
+}
+
+void HebirosSubscribers::twistCommand(const boost::shared_ptr<geometry_msgs::Twist const> data,
+  std::string group_name) {
+
+  HebirosGroup* group = hebiros::HebirosGroupRegistry::Instance().getGroup(group_name);
+
+  std::lock_guard<std::mutex> lock(group->model_mutex);
+  if (!group->model || !group->model->setTwist(*data)) {
+    ROS_WARN_THROTTLE(1, "Twist commands for hebiros/%s need a model without branches",
+      group_name.c_str());
+  }
+}
+
+// Called at the node rate; converts the last twist of each group into a joint
+// command and sends it.
+void HebirosSubscribers::sendTwistCommands() {
+
+  ros::Time time = ros::Time::now();
+  hebiros::HebirosGroupRegistry::Instance().forEachGroup(
+    [this, &time](const std::string& group_name, HebirosGroup& group) {
+
+    std::unique_lock<std::mutex> lock(group.model_mutex);
+    if (!group.model || !group.model->updateTwistCommand(time)) {
+      return;
+    }
+    // Sending may need the lock to hold the command for gravity compensation,
+    // and the model may be replaced once it is released, so send a copy.
+    twist_joint_data = group.model->twist_command_msg;
+    lock.unlock();
+
+    sendJointCommand(twist_joint_data, group_name);
+  });
+}
+
 void HebirosSubscribers::jointNotFound(std::string joint_name) {
   ROS_WARN("Unable to find joint: %s.  Command will not be sent.", joint_name.c_str());
 }
@@ -16,6 +16,11 @@ void HebirosSubscribersGazebo::registerGroupSubscribers(std::string group_name)
     "hebiros/"+group_name+"/command/joint_state", 100,
     boost::bind(&HebirosSubscribersGazebo::jointCommand, this, _1, group_name));
 
+  subscribers["hebiros/"+group_name+"/command/twist"] =
+    HebirosNode::n_ptr->subscribe<geometry_msgs::Twist>(
+    "hebiros/"+group_name+"/command/twist", 100,
+    boost::bind(&HebirosSubscribers::twistCommand, this, _1, group_name));
+
   subscribers["hebiros_gazebo_plugin/feedback/"+group_name] =
     HebirosNode::n_ptr->subscribe<FeedbackMsg>(
     "hebiros_gazebo_plugin/feedback/"+group_name, 100,
@@ -25,19 +30,32 @@ void HebirosSubscribersGazebo::registerGroupSubscribers(std::string group_name)
 void HebirosSubscribersGazebo::command(const boost::shared_ptr<CommandMsg const> data,
   std::string group_name) {
 
-  HebirosNode::publishers_gazebo.command(*data, group_name);
+  if (holdCommand(group_name, *data)) {
+    return;
+  }
+
+  HebirosNode::publishers_gazebo.command(data, group_name);
 }
 
 void HebirosSubscribersGazebo::jointCommand(
   const boost::shared_ptr<sensor_msgs::JointState const> data, std::string group_name) {
 
-  CommandMsg command_msg;
-  command_msg.name = data->name;
-  command_msg.position = data->position;
-  command_msg.velocity = data->velocity;
-  command_msg.effort = data->effort;
+  sendJointCommand(*data, group_name);
+}
+
+void HebirosSubscribersGazebo::sendJointCommand(const sensor_msgs::JointState& data,
+  std::string group_name) {
 
-  HebirosNode::publishers_gazebo.command(command_msg, group_name);
+  if (holdCommand(group_name, data, nullptr)) {
+    return;
+  }
+
+  joint_command_msg.name = data.name;
+  joint_command_msg.position = data.position;
+  joint_command_msg.velocity = data.velocity;
+  joint_command_msg.effort = data.effort;
+
+  HebirosNode::publishers_gazebo.command(joint_command_msg, group_name);
 }
 
 void HebirosSubscribersGazebo::feedback(const boost::shared_ptr<FeedbackMsg const> data,
@@ -51,19 +69,39 @@ void HebirosSubscribersGazebo::feedback(const boost::shared_ptr<FeedbackMsg cons
     return;
   }
 
-  FeedbackMsg feedback_msg = *data;
-  sensor_msgs::JointState joint_state_msg;
+  // The feedback is forwarded and kept as received; the group's joint state
+  // is rebuilt in place, reusing its storage
+  const FeedbackMsg& feedback_msg = *data;
+  group->feedback_msg = data;
+
+  sensor_msgs::JointState& joint_state_msg = group->joint_state_msg;
   joint_state_msg.header.stamp = ros::Time::now();
   joint_state_msg.name = feedback_msg.name;
   joint_state_msg.position = feedback_msg.position;
   joint_state_msg.velocity = feedback_msg.velocity;
   joint_state_msg.effort = feedback_msg.effort;
 
-  group->feedback_msg = feedback_msg;
-  group->joint_state_msg = joint_state_msg;
+  // Send gravity compensation first, to keep the latency from feedback to
+  // command low; publishing the model feedback reuses the gravity efforts.
+  {
+    std::lock_guard<std::mutex> lock(group->model_mutex);
+    if (group->model && group->model->getGravityCompensation() &&
+      group->model->updateGravityEfforts(feedback_msg)) {
+
+      // The simulator holds the current position or velocity for fields that
+      // are not commanded, which matches a missing field.
+      HebirosNode::publishers_gazebo.command(
+        group->model->getCommand(&feedback_msg), group_name);
+    }
+  }
+
+  if (HebirosParameters::getBool("hebiros/lockstep")) {
+    HebirosNode::publishers_gazebo.stepCommand(group_name);
+  }
 
-  HebirosNode::publishers_gazebo.feedback(feedback_msg, group_name);
+  HebirosNode::publishers_gazebo.feedback(data, group_name);
   HebirosNode::publishers_gazebo.feedbackJointState(joint_state_msg, group_name);
+  HebirosNode::publishers_gazebo.feedbackModel(feedback_msg, group_name);
 }
 
 
@@ -16,6 +16,11 @@ void HebirosSubscribersPhysical::registerGroupSubscribers(std::string group_name
     "hebiros/"+group_name+"/command/joint_state", 100,
     boost::bind(&HebirosSubscribersPhysical::jointCommand, this, _1, group_name));
 
+  subscribers["hebiros/"+group_name+"/command/twist"] =
+    HebirosNode::n_ptr->subscribe<geometry_msgs::Twist>(
+    "hebiros/"+group_name+"/command/twist", 100,
+    boost::bind(&HebirosSubscribers::twistCommand, this, _1, group_name));
+
   // TODO: replace with better abstraction later
   HebirosGroupPhysical* group = dynamic_cast<HebirosGroupPhysical*>
     (hebiros::HebirosGroupRegistry::Instance().getGroup(group_name));
@@ -24,7 +29,20 @@ void HebirosSubscribersPhysical::registerGroupSubscribers(std::string group_name
     return;
   }
   
-  group->group_ptr->requestInfo(group->group_info);
+  // Imitation groups have no info to request; their modules are the
+  // requested joints, in request order
+  group->module_names.resize(group->size);
+  if (!HebirosNode::use_imitation && group->group_ptr->requestInfo(group->group_info)) {
+    for (int i = 0; i < group->size; i++) {
+      group->module_names[i] = group->group_info[i].settings().family().get()+"/"+
+        group->group_info[i].settings().name().get();
+    }
+  }
+  else {
+    for (auto& joint : group->joints) {
+      group->module_names[joint.second] = joint.first;
+    }
+  }
 
   group->group_ptr->addFeedbackHandler([this, group_name](const GroupFeedback& group_fbk) {
     this->feedback(group_name, group_fbk);
@@ -56,7 +74,9 @@ void HebirosSubscribersPhysical::command(const boost::shared_ptr<CommandMsg cons
   settings_data = data->settings;
 
   GroupCommand group_command(group->size);
-  addJointCommand(&group_command, joint_data, group_name);
+  if (!holdCommand(group_name, joint_data, nullptr)) {
+    addJointCommand(&group_command, joint_data, group_name);
+  }
   addSettingsCommand(&group_command, settings_data, group_name);
 
   group->group_ptr->sendCommand(group_command);
@@ -65,6 +85,12 @@ void HebirosSubscribersPhysical::command(const boost::shared_ptr<CommandMsg cons
 void HebirosSubscribersPhysical::jointCommand(
   const boost::shared_ptr<sensor_msgs::JointState const> data, std::string group_name) {
 
+  sendJointCommand(*data, group_name);
+}
+
+void HebirosSubscribersPhysical::sendJointCommand(const sensor_msgs::JointState& data,
+  std::string group_name) {
+
   // TODO: replace with better abstraction later -- move send command into group
   HebirosGroupPhysical* group = dynamic_cast<HebirosGroupPhysical*>
     (hebiros::HebirosGroupRegistry::Instance().getGroup(group_name)); 
@@ -73,14 +99,12 @@ void HebirosSubscribersPhysical::jointCommand(
     return;
   }
 
-  sensor_msgs::JointState joint_data;
-  joint_data.name = data->name;
-  joint_data.position = data->position;
-  joint_data.velocity = data->velocity;
-  joint_data.effort = data->effort;
+  if (holdCommand(group_name, data, nullptr)) {
+    return;
+  }
 
   GroupCommand group_command(group->size);
-  addJointCommand(&group_command, joint_data, group_name);
+  addJointCommand(&group_command, data, group_name);
 
   group->group_ptr->sendCommand(group_command);
 }
@@ -373,23 +397,23 @@ void HebirosSubscribersPhysical::feedback(std::string group_name, const GroupFee
     return;
   }
 
-  FeedbackMsg feedback_msg;
+  FeedbackMsg::Ptr feedback_ptr = boost::make_shared<FeedbackMsg>();
+  FeedbackMsg& feedback_msg = *feedback_ptr;
   sensor_msgs::JointState joint_state_msg;
 
   for (int i = 0; i < group_fbk.size(); i++) {
-    std::string name = group->group_info[i].settings().name().get();
-    std::string family = group->group_info[i].settings().family().get();
+    const std::string& name = group->module_names[i];
     double position = group_fbk[i].actuator().position().get();
     double velocity = group_fbk[i].actuator().velocity().get();
     double effort = group_fbk[i].actuator().effort().get();
 
     joint_state_msg.header.stamp = ros::Time::now();
-    joint_state_msg.name.push_back(family+"/"+name);
+    joint_state_msg.name.push_back(name);
     joint_state_msg.position.push_back(position);
     joint_state_msg.velocity.push_back(velocity);
     joint_state_msg.effort.push_back(effort);
 
-    feedback_msg.name.push_back(family+"/"+name);
+    feedback_msg.name.push_back(name);
     feedback_msg.position.push_back(position);
     feedback_msg.velocity.push_back(velocity);
     feedback_msg.effort.push_back(effort);
@@ -446,11 +470,36 @@ void HebirosSubscribersPhysical::feedback(std::string group_name, const GroupFee
       group_fbk[i].actuator().hardwareTransmitTime().get());
   }
 
-  group->feedback_msg = feedback_msg;
+  group->feedback_msg = feedback_ptr;
   group->joint_state_msg = joint_state_msg;
 
-  HebirosNode::publishers_physical.feedback(feedback_msg, group_name);
+  // Send gravity compensation first, to keep the latency from feedback to
+  // command low; publishing the model feedback reuses the gravity efforts.
+  {
+    std::lock_guard<std::mutex> lock(group->model_mutex);
+    if (group->model && group->model->getGravityCompensation() &&
+      group->model->updateGravityEfforts(feedback_msg)) {
+
+      const CommandMsg& command_msg = group->model->getCommand();
+      GroupCommand group_command(group->size);
+      for (int i = 0; i < group->size; i++) {
+        if (!std::isnan(command_msg.position[i])) {
+          group_command[i].actuator().position().set(command_msg.position[i]);
+        }
+        if (!std::isnan(command_msg.velocity[i])) {
+          group_command[i].actuator().velocity().set(command_msg.velocity[i]);
+        }
+        if (!std::isnan(command_msg.effort[i])) {
+          group_command[i].actuator().effort().set(command_msg.effort[i]);
+        }
+      }
+      group->group_ptr->sendCommand(group_command);
+    }
+  }
+
+  HebirosNode::publishers_physical.feedback(feedback_ptr, group_name);
   HebirosNode::publishers_physical.feedbackJointState(joint_state_msg, group_name);
+  HebirosNode::publishers_physical.feedbackModel(feedback_msg, group_name);
 }
 
 
@@ -0,0 +1,63 @@
+#include "hebiros_urdf_cache.h"
+
+#include "hebiros.h"
+
+
+std::mutex HebirosURDFCache::mutex;
+std::map<std::string, HebirosURDFCache::Entry> HebirosURDFCache::entries;
+
+bool HebirosURDFCache::getDescription(const std::string& description_param,
+  std::string& description, uint64_t& hash) {
+
+  if (!HebirosNode::n_ptr->getParam(description_param, description)) {
+    ROS_WARN_STREAM("Could not load " << description_param);
+    return false;
+  }
+
+  hash = HebirosURDFCache::hash(description);
+  return true;
+}
+
+std::shared_ptr<const urdf::Model> HebirosURDFCache::get(const std::string& description_param) {
+
+  std::string description;
+  uint64_t hash;
+  if (!getDescription(description_param, description, hash))
+    return nullptr;
+
+  return get(description_param, description, hash);
+}
+
+std::shared_ptr<const urdf::Model> HebirosURDFCache::get(const std::string& description_param,
+  const std::string& description, uint64_t hash) {
+
+  // Held while parsing, so that a description is parsed once even if it is
+  // requested from several threads at the same time
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto entry = entries.find(description_param);
+  if (entry != entries.end() && entry->second.hash == hash) {
+    ROS_INFO_STREAM("Using cached URDF from " << description_param);
+    return entry->second.model;
+  }
+
+  std::shared_ptr<urdf::Model> model = std::make_shared<urdf::Model>();
+  if (!model->initString(description)) {
+    ROS_WARN_STREAM("Could not parse URDF from " << description_param);
+    return nullptr;
+  }
+
+  ROS_INFO_STREAM("Loaded URDF from " << description_param);
+  entries[description_param] = {hash, model};
+  return model;
+}
+
+uint64_t HebirosURDFCache::hash(const std::string& content) {
+
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : content) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
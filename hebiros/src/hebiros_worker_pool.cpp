@@ -0,0 +1,58 @@
+#include "hebiros_worker_pool.h"
+
+
+HebirosWorkerPool::~HebirosWorkerPool() {
+  stop();
+}
+
+void HebirosWorkerPool::start(size_t thread_count) {
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (running) {
+    return;
+  }
+  running = true;
+  for (size_t i = 0; i < thread_count; i++) {
+    threads.emplace_back(&HebirosWorkerPool::work, this);
+  }
+}
+
+void HebirosWorkerPool::post(std::function<void()> job) {
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(std::move(job));
+  }
+  condition.notify_one();
+}
+
+void HebirosWorkerPool::stop() {
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+    jobs.clear();
+  }
+  condition.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+}
+
+void HebirosWorkerPool::work() {
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    condition.wait(lock, [this] { return !running || !jobs.empty(); });
+    if (!running) {
+      return;
+    }
+    std::function<void()> job = std::move(jobs.front());
+    jobs.pop_front();
+
+    lock.unlock();
+    job();
+    lock.lock();
+  }
+}
@@ -0,0 +1,317 @@
+#include "sim/hebiros_actuator_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sim/temperature_safety_controller.h"
+
+namespace hebiros {
+namespace sim {
+
+namespace actuator_controller {
+
+static constexpr double MAX_PWM = 1.0;
+static constexpr double MIN_PWM = -1.0;
+
+static constexpr float VOLTAGE = 48.0f;
+static constexpr float SPEED_CONSTANT_X5 = 1530.0f;
+static constexpr float TERM_RESIST_X5 = 9.99f;
+static constexpr float SPEED_CONSTANT_X8 = 1360.0f;
+static constexpr float TERM_RESIST_X8 = 3.19f;
+
+static constexpr double MAX_WINDING_TEMPERATURE = 155.0;
+static constexpr double SAFETY_LAMBDA = 1.0;
+
+//Limit x to a value from low to high
+static inline double Clip(double x, double low, double high) {
+  return std::min(std::max(x, low), high);
+}
+
+//Compute the PID output for one joint, and advance its error state
+static inline double ComputePID(double kp, double ki, double kd,
+  double& prev_error, double& elapsed_error, double error_p, double dt) {
+
+  double error_i = elapsed_error + error_p;
+  double error_d = (dt <= 0) ? 0 : (error_p - prev_error) / dt;
+  prev_error = error_p;
+  elapsed_error = error_i;
+
+  return (kp * error_p) + (ki * error_i) + (kd * error_d);
+}
+
+static inline bool SameParameters(const TemperatureModel::Parameters& a,
+  const TemperatureModel::Parameters& b) {
+  return a.r_wh == b.r_wh && a.r_hb == b.r_hb && a.r_be == b.r_be &&
+    a.c_w == b.c_w && a.c_h == b.c_h && a.c_b == b.c_b;
+}
+
+//Gather the value at each command index, if the command has one
+static void GatherTargets(const std::vector<double>& source,
+  const std::vector<int>& command_indices,
+  std::vector<double>& target, std::vector<char>& has_target) {
+
+  for (size_t k = 0; k < command_indices.size(); k++) {
+    int j = command_indices[k];
+    has_target[k] = (j < source.size());
+    target[k] = has_target[k] ? source[j] : 0;
+  }
+}
+
+//Gather the gain at each command index
+static void GatherGains(const std::vector<double>& source,
+  const std::vector<int>& command_indices, std::vector<double>& gains) {
+
+  for (size_t k = 0; k < command_indices.size(); k++) {
+    int j = command_indices[k];
+    gains[k] = (j < source.size()) ? source[j] : 0;
+  }
+}
+}
+
+using namespace actuator_controller;
+
+size_t ActuatorController::size() const {
+  return force.size();
+}
+
+//Add a joint with zeroed state and no targets
+void ActuatorController::addJoint(double gear_ratio, bool is_x8,
+  const TemperatureModel& temperature) {
+
+  this->position.push_back(0);
+  this->velocity.push_back(0);
+  this->effort.push_back(0);
+  this->force.push_back(0);
+
+  this->winding_temperature.push_back(temperature.getMotorWindingTemperature());
+  this->housing_temperature.push_back(temperature.getMotorHousingTemperature());
+  this->body_temperature.push_back(temperature.getActuatorBodyTemperature());
+
+  for (size_t b = 0; b < 3; b++) {
+    Command& command = this->commands[b];
+    command.position_target.push_back(0);
+    command.velocity_target.push_back(0);
+    command.effort_target.push_back(0);
+    command.has_position_target.push_back(false);
+    command.has_velocity_target.push_back(false);
+    command.has_effort_target.push_back(false);
+
+    command.control_strategy.push_back(0);
+    command.position_kp.push_back(0);
+    command.position_ki.push_back(0);
+    command.position_kd.push_back(0);
+    command.velocity_kp.push_back(0);
+    command.velocity_ki.push_back(0);
+    command.velocity_kd.push_back(0);
+    command.effort_kp.push_back(0);
+    command.effort_ki.push_back(0);
+    command.effort_kd.push_back(0);
+  }
+
+  this->position_prev_error.push_back(0);
+  this->position_elapsed_error.push_back(0);
+  this->velocity_prev_error.push_back(0);
+  this->velocity_elapsed_error.push_back(0);
+  this->effort_prev_error.push_back(0);
+  this->effort_elapsed_error.push_back(0);
+
+  this->gear_ratio.push_back(gear_ratio);
+  this->speed_constant.push_back(is_x8 ? SPEED_CONSTANT_X8 : SPEED_CONSTANT_X5);
+  this->term_resist.push_back(is_x8 ? TERM_RESIST_X8 : TERM_RESIST_X5);
+
+  //Joints of the same actuator type share a thermal model
+  const TemperatureModel::Parameters& parameters = temperature.getParameters();
+  size_t model = 0;
+  while (model < this->thermal_parameters.size() &&
+    !SameParameters(this->thermal_parameters[model], parameters)) {
+    model++;
+  }
+  if (model == this->thermal_parameters.size()) {
+    this->thermal_parameters.push_back(parameters);
+    this->thermal_steps.push_back(TemperatureModel::discretize(parameters, 0));
+  }
+  this->thermal_model.push_back(model);
+  this->power_in.push_back(0);
+
+  this->max_pwm.push_back(MAX_PWM);
+  this->safety_limit_count.push_back(0);
+}
+
+//Gather a new command and settings into the back buffer, and publish it
+void ActuatorController::setCommand(const hebiros::CommandMsg& command,
+  const hebiros::SettingsMsg& settings, const std::vector<int>& command_indices,
+  const ros::Time& time) {
+
+  Command& target = this->commands.back();
+
+  GatherTargets(command.position, command_indices,
+    target.position_target, target.has_position_target);
+  GatherTargets(command.velocity, command_indices,
+    target.velocity_target, target.has_velocity_target);
+  GatherTargets(command.effort, command_indices,
+    target.effort_target, target.has_effort_target);
+
+  for (size_t k = 0; k < command_indices.size(); k++) {
+    int j = command_indices[k];
+    target.control_strategy[k] =
+      (j < settings.control_strategy.size()) ? settings.control_strategy[j] : 0;
+  }
+
+  GatherGains(settings.position_gains.kp, command_indices, target.position_kp);
+  GatherGains(settings.position_gains.ki, command_indices, target.position_ki);
+  GatherGains(settings.position_gains.kd, command_indices, target.position_kd);
+  GatherGains(settings.velocity_gains.kp, command_indices, target.velocity_kp);
+  GatherGains(settings.velocity_gains.ki, command_indices, target.velocity_ki);
+  GatherGains(settings.velocity_gains.kd, command_indices, target.velocity_kd);
+  GatherGains(settings.effort_gains.kp, command_indices, target.effort_kp);
+  GatherGains(settings.effort_gains.ki, command_indices, target.effort_ki);
+  GatherGains(settings.effort_gains.kd, command_indices, target.effort_kd);
+
+  target.time = time;
+  this->commands.publish();
+}
+
+bool ActuatorController::acquireCommand() {
+  if (this->commands.acquire()) {
+    this->command_acquired = true;
+    return true;
+  }
+  return false;
+}
+
+bool ActuatorController::hasCommand() const {
+  return this->command_acquired;
+}
+
+const ActuatorController::Command& ActuatorController::getCommand() const {
+  return this->commands.front();
+}
+
+//Compute output forces based on PID and control strategy, then update the
+//thermal models with the resulting motor power
+void ActuatorController::update(double dt) {
+
+  const Command& command = this->commands.front();
+  size_t size = this->size();
+  for (size_t k = 0; k < size; k++) {
+
+    double target_position = command.has_position_target[k] ?
+      command.position_target[k] : this->position[k];
+    double target_velocity = command.has_velocity_target[k] ?
+      command.velocity_target[k] : this->velocity[k];
+    double target_effort = command.has_effort_target[k] ?
+      command.effort_target[k] : this->effort[k];
+
+    //Strategies 2 to 4 run all three PIDs; they differ in the effort target
+    //and in how the outputs are combined. Strategies 0 and 1 leave the PID
+    //state untouched.
+    int strategy = command.control_strategy[k];
+    double pwm = 0;
+
+    if (strategy >= 2 && strategy <= 4) {
+      double position_pid = ComputePID(
+        command.position_kp[k], command.position_ki[k], command.position_kd[k],
+        this->position_prev_error[k], this->position_elapsed_error[k],
+        target_position - this->position[k], dt);
+      double velocity_pid = ComputePID(
+        command.velocity_kp[k], command.velocity_ki[k], command.velocity_kd[k],
+        this->velocity_prev_error[k], this->velocity_elapsed_error[k],
+        target_velocity - this->velocity[k], dt);
+
+      double intermediate_effort = target_effort;
+      if (strategy == 2) {
+        intermediate_effort = target_effort + position_pid + velocity_pid;
+      }
+      else if (strategy == 4) {
+        intermediate_effort = target_effort + position_pid;
+      }
+
+      double effort_pwm = Clip(ComputePID(
+        command.effort_kp[k], command.effort_ki[k], command.effort_kd[k],
+        this->effort_prev_error[k], this->effort_elapsed_error[k],
+        intermediate_effort - this->effort[k], dt), MIN_PWM, MAX_PWM);
+      double velocity_pwm = Clip(velocity_pid, MIN_PWM, MAX_PWM);
+
+      if (strategy == 2) {
+        pwm = effort_pwm;
+      }
+      else if (strategy == 3) {
+        double position_pwm = Clip(position_pid, MIN_PWM, MAX_PWM);
+        pwm = Clip(position_pwm + velocity_pwm + effort_pwm, MIN_PWM, MAX_PWM);
+      }
+      else {
+        pwm = Clip(velocity_pwm + effort_pwm, MIN_PWM, MAX_PWM);
+      }
+    }
+    else if (strategy == 1) {
+      pwm = Clip(target_effort, MIN_PWM, MAX_PWM);
+    }
+
+    //Temperature safety limit
+    if (pwm > this->max_pwm[k]) {
+      pwm = this->max_pwm[k];
+      this->safety_limit_count[k]++;
+    }
+    else if (pwm < -this->max_pwm[k]) {
+      pwm = -this->max_pwm[k];
+      this->safety_limit_count[k]++;
+    }
+
+    double gear_ratio = this->gear_ratio[k];
+    float motor_velocity = this->velocity[k] * gear_ratio;
+    float speed_constant = this->speed_constant[k];
+    float term_resist = this->term_resist[k];
+
+    if (pwm == 0) {
+      this->force[k] = 0;
+    }
+    else {
+      this->force[k] = ((pwm*VOLTAGE - (motor_velocity/speed_constant)) / term_resist) *
+        0.00626 * gear_ratio * 0.65;
+    }
+
+    float prev_winding_temp = this->winding_temperature[k];
+
+    // Get components of power into the motor
+
+    // Temperature compensated speed constant
+    float comp_speed_constant = speed_constant * 1.05f * // Experimental tuning factor
+      (1.f + .001f * (prev_winding_temp - 20.f)); // .001 is speed constant change per temperature change
+    float winding_resistance = term_resist *
+      (1.f + .004f * (prev_winding_temp - 20.f)); // .004 is resistance change per temperature change for copper
+    float back_emf = (motor_velocity * 30.f / M_PI) / comp_speed_constant;
+    float winding_voltage = pwm * VOLTAGE - back_emf;
+
+    // Power = I^2R, but I = V/R so I^2R = V^2/R:
+    this->power_in[k] = winding_voltage * winding_voltage / winding_resistance;
+  }
+
+  //Advance the thermal models of all joints, one batch per run of joints
+  //with the same parameters; discretizations are only recomputed when dt
+  //changes
+  for (size_t m = 0; m < this->thermal_steps.size(); m++) {
+    if (this->thermal_steps[m].dt != dt) {
+      this->thermal_steps[m] = TemperatureModel::discretize(this->thermal_parameters[m], dt);
+    }
+  }
+
+  size_t begin = 0;
+  while (begin < size) {
+    size_t end = begin + 1;
+    while (end < size && this->thermal_model[end] == this->thermal_model[begin]) {
+      end++;
+    }
+    TemperatureModel::update(this->thermal_steps[this->thermal_model[begin]],
+      end - begin, &this->power_in[begin], &this->winding_temperature[begin],
+      &this->housing_temperature[begin], &this->body_temperature[begin]);
+    begin = end;
+  }
+
+  for (size_t k = 0; k < size; k++) {
+    this->max_pwm[k] = TemperatureSafetyController::computeMaxPwm(
+      MAX_WINDING_TEMPERATURE, SAFETY_LAMBDA, this->winding_temperature[k]);
+  }
+}
+
+}
+}
@@ -0,0 +1,319 @@
+#include "sim/hebiros_actuator_settings.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "ros/ros.h"
+#include "ros/package.h"
+
+namespace hebiros {
+namespace sim {
+
+namespace actuator_settings {
+
+enum class control_strategies {
+  CONTROL_STRATEGY_OFF = 0,
+  CONTROL_STRATEGY_DIRECT_PWM = 1,
+  CONTROL_STRATEGY_2 = 2,
+  CONTROL_STRATEGY_3 = 3,
+  CONTROL_STRATEGY_4 = 4
+};
+
+static constexpr control_strategies DEFAULT_CONTROL_STRATEGY = control_strategies::CONTROL_STRATEGY_3;
+
+static constexpr double DEFAULT_POSITION_KP = 0.5;
+static constexpr double DEFAULT_VELOCITY_KP = 0.05;
+static constexpr double DEFAULT_EFFORT_KP = 0.25;
+static constexpr double DEFAULT_EFFORT_KD = 0.001;
+
+static constexpr double GEAR_RATIO_X5_1 = 272.22;
+static constexpr double GEAR_RATIO_X8_3 = 272.22;
+static constexpr double GEAR_RATIO_X5_4 = 762.22;
+static constexpr double GEAR_RATIO_X8_9 = 762.22;
+static constexpr double GEAR_RATIO_X5_9 = 1742.22;
+static constexpr double GEAR_RATIO_X8_16 = 1462.222;
+
+static constexpr double DEFAULT_GEAR_RATIO = 272.22;
+
+static const std::map<std::string, double> gear_ratios = {
+  {"X5_1", GEAR_RATIO_X5_1},
+  {"X5_4", GEAR_RATIO_X5_4},
+  {"X5_9", GEAR_RATIO_X5_9},
+  {"X8_3", GEAR_RATIO_X8_3},
+  {"X8_9", GEAR_RATIO_X8_9},
+  {"X8_16", GEAR_RATIO_X8_16}};
+
+// Gains with only proportional terms, and a derivative term on effort
+static ActuatorSettings::Gains pdGains(double position_kp, double velocity_kp,
+  double effort_kp, double effort_kd) {
+  ActuatorSettings::Gains gains;
+  gains.position = {{position_kp, 0, 0}};
+  gains.velocity = {{velocity_kp, 0, 0}};
+  gains.effort = {{effort_kp, 0, effort_kd}};
+  return gains;
+}
+
+// Built-in gains of control strategies 2, 3 and 4, for models without gains
+// files; the files in the gains directory hold the same values.
+static const std::map<std::string, std::array<ActuatorSettings::Gains, 3>> built_in_gains = {
+  {"X5_1", {{pdGains(5, 0.1, 0.25, 0.001), pdGains(0.5, 0.05, 0.25, 0.001), pdGains(5, 0.05, 0.25, 0.001)}}},
+  {"X5_4", {{pdGains(10, 0.2, 0.25, 0.001), pdGains(1, 0.05, 0.25, 0.001), pdGains(10, 0.05, 0.25, 0.001)}}},
+  {"X5_9", {{pdGains(15, 0.5, 0.25, 0.001), pdGains(1.5, 0.05, 0.25, 0.001), pdGains(15, 0.05, 0.25, 0.001)}}},
+  {"X8_3", {{pdGains(3, 0.1, 0.1, 0.0001), pdGains(1, 0.03, 0.1, 0.0001), pdGains(3, 0.03, 0.1, 0.0001)}}},
+  {"X8_9", {{pdGains(5, 0.1, 0.1, 0.0001), pdGains(2, 0.03, 0.1, 0.0001), pdGains(5, 0.03, 0.1, 0.0001)}}},
+  {"X8_16", {{pdGains(5, 0.1, 0.1, 0.0001), pdGains(3, 0.03, 0.1, 0.0001), pdGains(5, 0.03, 0.1, 0.0001)}}}};
+
+static constexpr int FIRST_GAINS_STRATEGY = 2;
+static constexpr int LAST_GAINS_STRATEGY = 4;
+
+// Finds the next element "tag" in xml[begin, end), and sets the range of its
+// content
+static bool findElement(const std::string& xml, const std::string& tag,
+  size_t begin, size_t end, size_t& content_begin, size_t& content_end) {
+
+  std::string open = "<" + tag + ">";
+  std::string close = "</" + tag + ">";
+
+  size_t start = xml.find(open, begin);
+  if (start == std::string::npos || start + open.size() > end) {
+    return false;
+  }
+  content_begin = start + open.size();
+  content_end = xml.find(close, content_begin);
+  return (content_end != std::string::npos && content_end + close.size() <= end);
+}
+
+// Reads the first value (that of the first module) of an element
+static bool readFirstValue(const std::string& xml, const std::string& tag,
+  size_t begin, size_t end, double& value) {
+
+  size_t content_begin, content_end;
+  if (!findElement(xml, tag, begin, end, content_begin, content_end)) {
+    return false;
+  }
+  const char* text = xml.c_str() + content_begin;
+  char* text_end;
+  double parsed = std::strtod(text, &text_end);
+  if (text_end == text || text_end > xml.c_str() + content_end) {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+static void readPidGains(const std::string& xml, const std::string& tag,
+  size_t begin, size_t end, ActuatorSettings::PidGains& gains) {
+
+  size_t content_begin, content_end;
+  if (findElement(xml, tag, begin, end, content_begin, content_end)) {
+    readFirstValue(xml, "kp", content_begin, content_end, gains[0]);
+    readFirstValue(xml, "ki", content_begin, content_end, gains[1]);
+    readFirstValue(xml, "kd", content_begin, content_end, gains[2]);
+  }
+}
+
+static void setGains(const ActuatorSettings::Gains& gains, int i,
+  hebiros::SettingsMsg& settings) {
+
+  settings.position_gains.kp[i] = gains.position[0];
+  settings.position_gains.ki[i] = gains.position[1];
+  settings.position_gains.kd[i] = gains.position[2];
+  settings.velocity_gains.kp[i] = gains.velocity[0];
+  settings.velocity_gains.ki[i] = gains.velocity[1];
+  settings.velocity_gains.kd[i] = gains.velocity[2];
+  settings.effort_gains.kp[i] = gains.effort[0];
+  settings.effort_gains.ki[i] = gains.effort[1];
+  settings.effort_gains.kd[i] = gains.effort[2];
+}
+
+// Builds the default gains table of each model, from the gains files where
+// there are some
+static std::map<std::string, ActuatorSettings::GainsTable> loadDefaultGains() {
+
+  std::map<std::string, ActuatorSettings::GainsTable> tables;
+  std::string directory = ros::package::getPath("hebiros") + "/gains/";
+  int missing_files = 0;
+
+  for (auto& model : built_in_gains) {
+    ActuatorSettings::GainsTable table;
+
+    for (int strategy = FIRST_GAINS_STRATEGY; strategy <= LAST_GAINS_STRATEGY; ++strategy) {
+      ActuatorSettings::Gains gains = model.second[strategy - FIRST_GAINS_STRATEGY];
+      std::string file_name = directory + model.first + "_strategy" +
+        std::to_string(strategy) + ".xml";
+
+      if (!ActuatorSettings::readStrategyGains(file_name, strategy, gains)) {
+        missing_files++;
+      }
+      table[strategy] = gains;
+    }
+
+    //Strategies without gains of their own keep those of the default strategy
+    table[0] = table[1] = table[static_cast<int>(DEFAULT_CONTROL_STRATEGY)];
+    tables[model.first] = table;
+  }
+
+  if (missing_files > 0) {
+    ROS_WARN("%d gains files missing from %s; using built-in gains for them", missing_files,
+      directory.c_str());
+  }
+
+  ActuatorSettings::GainsTable default_table;
+  default_table.fill(pdGains(DEFAULT_POSITION_KP, DEFAULT_VELOCITY_KP, DEFAULT_EFFORT_KP,
+    DEFAULT_EFFORT_KD));
+  tables[""] = default_table;
+
+  return tables;
+}
+}
+
+using namespace actuator_settings;
+
+double ActuatorSettings::getGearRatio(const std::string& model_name) {
+  auto gear_ratio = gear_ratios.find(model_name);
+  if (gear_ratio != gear_ratios.end()) {
+    return gear_ratio->second;
+  }
+  return DEFAULT_GEAR_RATIO;
+}
+
+bool ActuatorSettings::isX8(const std::string& model_name) {
+  return (model_name == "X8_3" ||
+          model_name == "X8_9" ||
+          model_name == "X8_16");
+}
+
+const ActuatorSettings::GainsTable& ActuatorSettings::getDefaultGains(
+  const std::string& model_name) {
+
+  //Loaded on first use, by whichever thread gets here first
+  static const std::map<std::string, GainsTable> default_gains = loadDefaultGains();
+
+  auto table = default_gains.find(model_name);
+  if (table != default_gains.end()) {
+    return table->second;
+  }
+  return default_gains.at("");
+}
+
+bool ActuatorSettings::readGainsFile(const std::string& file_name, int& control_strategy,
+  Gains& gains) {
+
+  std::ifstream file(file_name);
+  if (!file) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const std::string xml = buffer.str();
+
+  size_t begin, end;
+  if (!findElement(xml, "group_gains", 0, xml.size(), begin, end)) {
+    ROS_WARN("%s is not a gains file", file_name.c_str());
+    return false;
+  }
+
+  double strategy;
+  if (readFirstValue(xml, "control_strategy", begin, end, strategy)) {
+    control_strategy = static_cast<int>(strategy);
+  }
+  readPidGains(xml, "position", begin, end, gains.position);
+  readPidGains(xml, "velocity", begin, end, gains.velocity);
+  readPidGains(xml, "effort", begin, end, gains.effort);
+  return true;
+}
+
+bool ActuatorSettings::readStrategyGains(const std::string& file_name, int control_strategy,
+  Gains& gains) {
+
+  int file_strategy = control_strategy;
+  Gains file_gains = gains;
+  if (!readGainsFile(file_name, file_strategy, file_gains)) {
+    return false;
+  }
+  if (file_strategy != control_strategy) {
+    ROS_WARN("%s is for control strategy %d; using built-in gains", file_name.c_str(),
+      file_strategy);
+    return true;
+  }
+  gains = file_gains;
+  return true;
+}
+
+//Initialize the control strategy, and its default gains
+void ActuatorSettings::addDefaults(const std::string& name, const GainsTable& defaults,
+  hebiros::SettingsMsg& settings) {
+
+  settings.name.push_back(name);
+  settings.control_strategy.push_back(static_cast<char>(DEFAULT_CONTROL_STRATEGY));
+
+  size_t size = settings.name.size();
+  settings.position_gains.kp.resize(size);
+  settings.position_gains.ki.resize(size);
+  settings.position_gains.kd.resize(size);
+  settings.velocity_gains.kp.resize(size);
+  settings.velocity_gains.ki.resize(size);
+  settings.velocity_gains.kd.resize(size);
+  settings.effort_gains.kp.resize(size);
+  settings.effort_gains.ki.resize(size);
+  settings.effort_gains.kd.resize(size);
+  setGains(defaults[static_cast<int>(DEFAULT_CONTROL_STRATEGY)], size - 1, settings);
+}
+
+//Change settings for a joint if specifically commanded
+void ActuatorSettings::change(const hebiros::SettingsMsg& changes, int i,
+  const GainsTable& defaults, hebiros::SettingsMsg& settings) {
+
+  //Set name
+  if (i < changes.name.size()) {
+    settings.name[i] = changes.name[i];
+  }
+
+  //Change control strategy, starting from its default gains
+  if (i < changes.control_strategy.size() &&
+      changes.control_strategy[i] != settings.control_strategy[i]) {
+    settings.control_strategy[i] = changes.control_strategy[i];
+    int control_strategy = settings.control_strategy[i];
+    if (control_strategy >= 0 && control_strategy < static_cast<int>(defaults.size())) {
+      setGains(defaults[control_strategy], i, settings);
+    }
+  }
+
+  //Change position gains
+  if (i < changes.position_gains.kp.size()) {
+    settings.position_gains.kp[i] = changes.position_gains.kp[i];
+  }
+  if (i < changes.position_gains.ki.size()) {
+    settings.position_gains.ki[i] = changes.position_gains.ki[i];
+  }
+  if (i < changes.position_gains.kd.size()) {
+    settings.position_gains.kd[i] = changes.position_gains.kd[i];
+  }
+
+  //Change velocity gains
+  if (i < changes.velocity_gains.kp.size()) {
+    settings.velocity_gains.kp[i] = changes.velocity_gains.kp[i];
+  }
+  if (i < changes.velocity_gains.ki.size()) {
+    settings.velocity_gains.ki[i] = changes.velocity_gains.ki[i];
+  }
+  if (i < changes.velocity_gains.kd.size()) {
+    settings.velocity_gains.kd[i] = changes.velocity_gains.kd[i];
+  }
+
+  //Change effort gains
+  if (i < changes.effort_gains.kp.size()) {
+    settings.effort_gains.kp[i] = changes.effort_gains.kp[i];
+  }
+  if (i < changes.effort_gains.ki.size()) {
+    settings.effort_gains.ki[i] = changes.effort_gains.ki[i];
+  }
+  if (i < changes.effort_gains.kd.size()) {
+    settings.effort_gains.kd[i] = changes.effort_gains.kd[i];
+  }
+}
+
+}
+}
@@ -0,0 +1,169 @@
+#include "sim/hebiros_shm_ring.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hebiros {
+namespace sim {
+
+namespace shm_ring {
+
+// Marks a ring as initialized ("HRNG"), and tells a foreign shared memory
+// object apart from a ring
+static constexpr uint32_t MAGIC = 0x48524e47;
+
+// Space reserved for the header, so that slots start on a cache line
+static constexpr size_t HEADER_SIZE = 64;
+
+//Size of the mapping for a ring, with room for each slot's length
+static size_t MappingSize(uint32_t slot_count, uint32_t slot_size) {
+  return HEADER_SIZE + static_cast<size_t>(slot_count) * (sizeof(uint32_t) + slot_size);
+}
+}
+
+using namespace shm_ring;
+
+//Shared memory names are a single path component, so every "/" past the
+//first becomes "_"
+std::string ShmRing::nameForTopic(const std::string& topic) {
+  std::string name = "/hebiros";
+  for (char c : topic) {
+    name += (c == '/') ? '_' : c;
+  }
+  return name;
+}
+
+std::unique_ptr<ShmRing> ShmRing::create(const std::string& name,
+  uint32_t slot_count, uint32_t slot_size) {
+
+  static_assert(sizeof(Header) <= HEADER_SIZE, "ring header too large");
+
+  //Replace any ring left by an earlier owner; its readers keep their mapping
+  //of it, and have to open the new one
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  size_t size = MappingSize(slot_count, slot_size);
+  void* memory = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (memory == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+
+  //The new object is zero-filled; the magic number is stored last
+  Header* header = new (memory) Header();
+  header->slot_count = slot_count;
+  header->slot_size = slot_size;
+  header->magic.store(MAGIC, std::memory_order_release);
+
+  return std::unique_ptr<ShmRing>(new ShmRing(name, memory, size, true));
+}
+
+std::unique_ptr<ShmRing> ShmRing::open(const std::string& name) {
+
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  struct stat status;
+  void* memory = MAP_FAILED;
+  if (fstat(fd, &status) == 0 && status.st_size >= static_cast<off_t>(sizeof(Header))) {
+    memory = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (memory == MAP_FAILED) {
+    return nullptr;
+  }
+
+  //Only use a ring that is initialized and as large as its header says
+  Header* header = static_cast<Header*>(memory);
+  if (header->magic.load(std::memory_order_acquire) != MAGIC ||
+    MappingSize(header->slot_count, header->slot_size) > static_cast<size_t>(status.st_size)) {
+    munmap(memory, status.st_size);
+    return nullptr;
+  }
+
+  return std::unique_ptr<ShmRing>(new ShmRing(name, memory, status.st_size, false));
+}
+
+ShmRing::ShmRing(const std::string& name, void* memory, size_t size, bool owner)
+  : name(name), memory(memory), size(size), owner(owner),
+    header(static_cast<Header*>(memory)) {
+}
+
+//The owner also marks the ring as unread, so that a writer on the other side
+//stops using it
+ShmRing::~ShmRing() {
+  if (this->owner) {
+    attachReader(false);
+    shm_unlink(this->name.c_str());
+  }
+  munmap(this->memory, this->size);
+}
+
+void ShmRing::attachReader(bool attached) {
+  if (attached) {
+    this->header->tail.store(this->header->head.load(std::memory_order_acquire),
+      std::memory_order_release);
+  }
+  this->header->reader_attached.store(attached ? 1 : 0, std::memory_order_release);
+}
+
+bool ShmRing::hasReader() const {
+  return this->header->reader_attached.load(std::memory_order_acquire) != 0;
+}
+
+uint8_t* ShmRing::slot(uint64_t index) {
+  size_t offset = HEADER_SIZE + (index % this->header->slot_count) * (sizeof(uint32_t) + this->header->slot_size);
+  return static_cast<uint8_t*>(this->memory) + offset;
+}
+
+//Slot for a message of "length" bytes, past its length field
+uint8_t* ShmRing::beginWrite(uint32_t length) {
+  uint64_t head = this->header->head.load(std::memory_order_relaxed);
+  uint64_t tail = this->header->tail.load(std::memory_order_acquire);
+  if (length > this->header->slot_size || head - tail >= this->header->slot_count) {
+    return nullptr;
+  }
+  return slot(head) + sizeof(uint32_t);
+}
+
+void ShmRing::endWrite(uint32_t length) {
+  uint64_t head = this->header->head.load(std::memory_order_relaxed);
+  std::memcpy(slot(head), &length, sizeof(uint32_t));
+  this->header->head.store(head + 1, std::memory_order_release);
+}
+
+uint8_t* ShmRing::beginRead(uint32_t& length) {
+  uint64_t tail = this->header->tail.load(std::memory_order_relaxed);
+  uint64_t head = this->header->head.load(std::memory_order_acquire);
+  if (tail == head) {
+    return nullptr;
+  }
+  uint8_t* data = slot(tail);
+  std::memcpy(&length, data, sizeof(uint32_t));
+  length = std::min(length, this->header->slot_size);
+  return data + sizeof(uint32_t);
+}
+
+void ShmRing::endRead() {
+  uint64_t tail = this->header->tail.load(std::memory_order_relaxed);
+  this->header->tail.store(tail + 1, std::memory_order_release);
+}
+
+}
+}
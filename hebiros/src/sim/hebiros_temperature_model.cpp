@@ -0,0 +1,97 @@
+#include "sim/hebiros_temperature_model.h"
+
+#include "Eigen/Eigen"
+#include "unsupported/Eigen/MatrixFunctions"
+
+namespace hebiros {
+namespace sim {
+
+constexpr double TemperatureModel::t_e_;
+
+TemperatureModel TemperatureModel::createX5() {
+  double r_be = 8.0; // (found experimentally from steady-state experiments)
+  return TemperatureModel(
+    2.57 * 1.8,     // r_wh (datasheet)
+    1.0,            // r_hb (Open air from data sheet divided by empirical factor)
+    r_be,              
+    0.943 / 2.57,   // c_w (winding, datasheet; tc_winding / rth_winding)
+    390.0 / 23.5,   // c_h (housing, datasheet) (TC / R)
+    10000.0 / r_be  // c_b actuator body; from experimentally measured time constant
+  );
+}
+
+TemperatureModel TemperatureModel::createX8() {
+  double r_be = 4.0; // (found experimentally from steady-state experiments)
+  return TemperatureModel(
+    1.41 * 1.6,     // r_wh (datasheet)
+    1.0,            // r_hb (Open air from data sheet divided by empirical factor)
+    r_be,              
+    0.9 / 1.41,     // c_w (winding, datasheet; tc_winding / rth_winding)
+    427.0 / 17.7,   // c_h (housing, datasheet) (TC / R)
+    10000.0 / r_be  // c_b actuator body; from experimentally measured time constant
+  );
+}
+
+// The model is linear, x' = A x + b power_in. Both phi = exp(A dt) and
+// gamma = integral of exp(A s) b over the step come from the exponential of
+// the augmented system [A b; 0 0] dt, whose top rows are [phi gamma].
+TemperatureModel::Step TemperatureModel::discretize(const Parameters& params, double dt) {
+  double g_wh = 1.0 / params.r_wh;
+  double g_hb = 1.0 / params.r_hb;
+  double g_be = 1.0 / params.r_be;
+
+  Eigen::Matrix4d system = Eigen::Matrix4d::Zero();
+  system(0, 0) = -g_wh / params.c_w;
+  system(0, 1) = g_wh / params.c_w;
+  system(1, 0) = g_wh / params.c_h;
+  system(1, 1) = -(g_wh + g_hb) / params.c_h;
+  system(1, 2) = g_hb / params.c_h;
+  system(2, 1) = g_hb / params.c_b;
+  system(2, 2) = -(g_hb + g_be) / params.c_b;
+  system(0, 3) = 1.0 / params.c_w;
+
+  Eigen::Matrix4d transition = (system * dt).exp();
+
+  Step step;
+  step.dt = dt;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j)
+      step.phi[i][j] = transition(i, j);
+    step.gamma[i] = transition(i, 3);
+  }
+  return step;
+}
+
+void TemperatureModel::update(const Step& step, size_t n, const double* power_in,
+  double* t_w, double* t_h, double* t_b) {
+  for (size_t i = 0; i < n; ++i) {
+    double x_w = t_w[i] - t_e_;
+    double x_h = t_h[i] - t_e_;
+    double x_b = t_b[i] - t_e_;
+
+    t_w[i] = t_e_ + step.phi[0][0] * x_w + step.phi[0][1] * x_h +
+      step.phi[0][2] * x_b + step.gamma[0] * power_in[i];
+    t_h[i] = t_e_ + step.phi[1][0] * x_w + step.phi[1][1] * x_h +
+      step.phi[1][2] * x_b + step.gamma[1] * power_in[i];
+    t_b[i] = t_e_ + step.phi[2][0] * x_w + step.phi[2][1] * x_h +
+      step.phi[2][2] * x_b + step.gamma[2] * power_in[i];
+  }
+}
+
+// Perform an update of all of the stages of the model,
+// based on the estimated power going into the system
+void TemperatureModel::update(double power_in, double dt) {
+  if (step_.dt != dt)
+    step_ = discretize(params_, dt);
+  update(step_, 1, &power_in, &t_w_, &t_h_, &t_b_);
+}
+
+TemperatureModel::TemperatureModel(
+  double r_wh, double r_hb, double r_be,
+  double c_w, double c_h, double c_b)
+  : params_{r_wh, r_hb, r_be, c_w, c_h, c_b},
+    step_(discretize(params_, 0)) {
+}
+
+}
+}
@@ -1,4 +1,4 @@
-#include "temperature_safety_controller.h"
+#include "sim/temperature_safety_controller.h"
 
 namespace hebiros {
 namespace sim {
@@ -8,16 +8,20 @@ TemperatureSafetyController::TemperatureSafetyController(double max_temp)
 }
 
 void TemperatureSafetyController::update(double measured_temp) {
-  if (measured_temp >= max_temp_) {
-    max_pwm_ = 0;
-    return;
+  max_pwm_ = computeMaxPwm(max_temp_, lambda_, measured_temp);
+}
+
+double TemperatureSafetyController::computeMaxPwm(double max_temp, double lambda,
+  double measured_temp) {
+  if (measured_temp >= max_temp) {
+    return 0;
   }
-  float d_val = max_temp_ - measured_temp;
-  float d_pwm = lambda_ / d_val;
+  float d_val = max_temp - measured_temp;
+  float d_pwm = lambda / d_val;
   if (d_pwm > 1.0)    
-    max_pwm_ = 0;
+    return 0;
   else
-    max_pwm_ = 1.0 - d_pwm;
+    return 1.0 - d_pwm;
 }
 
 double TemperatureSafetyController::limit(double raw_value) {
@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "sim/hebiros_actuator_controller.h"
+#include "sim/temperature_safety_controller.h"
+
+using namespace hebiros;
+using namespace hebiros::sim;
+
+// The per-joint controller that ActuatorController replaced (from the Gazebo
+// plugin's HebirosGazeboController::ComputeForce), kept as the reference its
+// forces have to match exactly.
+struct ReferenceJoint {
+  ReferenceJoint(double gear_ratio, bool is_x8)
+    : gear_ratio(gear_ratio), is_x8(is_x8),
+      temperature(is_x8 ? TemperatureModel::createX8() : TemperatureModel::createX5()),
+      temperature_safety(155) {}
+
+  double gear_ratio;
+  bool is_x8;
+  TemperatureModel temperature;
+  TemperatureSafetyController temperature_safety;
+
+  double position_prev_error = 0;
+  double position_elapsed_error = 0;
+  double velocity_prev_error = 0;
+  double velocity_elapsed_error = 0;
+  double effort_prev_error = 0;
+  double effort_elapsed_error = 0;
+};
+
+static double referenceClip(double x, double low, double high) {
+  return std::min(std::max(x, low), high);
+}
+
+static double referencePID(const PidGainsMsg& gains, int i, double& prev_error,
+  double& elapsed_error, double target, double measured, double dt) {
+
+  double error_p = target - measured;
+  double error_i = elapsed_error + error_p;
+  double error_d = (error_p - prev_error) / dt;
+  prev_error = error_p;
+  elapsed_error = error_i;
+  if (dt <= 0)
+    error_d = 0;
+  return (gains.kp[i] * error_p) + (gains.ki[i] * error_i) + (gains.kd[i] * error_d);
+}
+
+static double referenceForce(const CommandMsg& target, const SettingsMsg& settings,
+  ReferenceJoint& joint, int i, double position, double velocity, double effort, double dt) {
+
+  double target_position = (i < target.position.size()) ? target.position[i] : position;
+  double target_velocity = (i < target.velocity.size()) ? target.velocity[i] : velocity;
+  double target_effort = (i < target.effort.size()) ? target.effort[i] : effort;
+
+  double position_pid, velocity_pid, effort_pwm, velocity_pwm, position_pwm, pwm;
+  switch (settings.control_strategy[i]) {
+    case 1:
+      pwm = referenceClip(target_effort, -1, 1);
+      break;
+
+    case 2:
+      position_pid = referencePID(settings.position_gains, i, joint.position_prev_error,
+        joint.position_elapsed_error, target_position, position, dt);
+      velocity_pid = referencePID(settings.velocity_gains, i, joint.velocity_prev_error,
+        joint.velocity_elapsed_error, target_velocity, velocity, dt);
+      pwm = referenceClip(referencePID(settings.effort_gains, i, joint.effort_prev_error,
+        joint.effort_elapsed_error, target_effort + position_pid + velocity_pid, effort, dt),
+        -1, 1);
+      break;
+
+    case 3:
+      position_pwm = referenceClip(referencePID(settings.position_gains, i,
+        joint.position_prev_error, joint.position_elapsed_error, target_position, position, dt),
+        -1, 1);
+      velocity_pwm = referenceClip(referencePID(settings.velocity_gains, i,
+        joint.velocity_prev_error, joint.velocity_elapsed_error, target_velocity, velocity, dt),
+        -1, 1);
+      effort_pwm = referenceClip(referencePID(settings.effort_gains, i,
+        joint.effort_prev_error, joint.effort_elapsed_error, target_effort, effort, dt),
+        -1, 1);
+      pwm = referenceClip(position_pwm + velocity_pwm + effort_pwm, -1, 1);
+      break;
+
+    case 4:
+      position_pid = referencePID(settings.position_gains, i, joint.position_prev_error,
+        joint.position_elapsed_error, target_position, position, dt);
+      effort_pwm = referenceClip(referencePID(settings.effort_gains, i, joint.effort_prev_error,
+        joint.effort_elapsed_error, target_effort + position_pid, effort, dt), -1, 1);
+      velocity_pwm = referenceClip(referencePID(settings.velocity_gains, i,
+        joint.velocity_prev_error, joint.velocity_elapsed_error, target_velocity, velocity, dt),
+        -1, 1);
+      pwm = referenceClip(velocity_pwm + effort_pwm, -1, 1);
+      break;
+
+    default:
+      pwm = 0;
+  }
+
+  float voltage = 48.0f;
+  float motor_velocity = velocity * joint.gear_ratio;
+  float speed_constant = joint.is_x8 ? 1360.0f : 1530.0f;
+  float term_resist = joint.is_x8 ? 3.19f : 9.99f;
+
+  pwm = joint.temperature_safety.limit(pwm);
+
+  double force = 0;
+  if (pwm != 0)
+    force = ((pwm*voltage - (motor_velocity/speed_constant)) / term_resist) * 0.00626 *
+      joint.gear_ratio * 0.65;
+
+  float prev_winding_temp = joint.temperature.getMotorWindingTemperature();
+  float comp_speed_constant = speed_constant * 1.05f * (1.f + .001f * (prev_winding_temp - 20.f));
+  float winding_resistance = term_resist * (1.f + .004f * (prev_winding_temp - 20.f));
+  float back_emf = (motor_velocity * 30.f / M_PI) / comp_speed_constant;
+  float winding_voltage = pwm * voltage - back_emf;
+  double power_in = winding_voltage * winding_voltage / winding_resistance;
+  joint.temperature.update(power_in, dt);
+  joint.temperature_safety.update(joint.temperature.getMotorWindingTemperature());
+
+  return force;
+}
+
+static void fillGains(PidGainsMsg& gains, size_t size, std::mt19937& generator) {
+  std::uniform_real_distribution<double> distribution(0, 2);
+  gains.kp.resize(size);
+  gains.ki.resize(size);
+  gains.kd.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    gains.kp[i] = distribution(generator);
+    gains.ki[i] = distribution(generator) * 0.01;
+    gains.kd[i] = distribution(generator) * 0.001;
+  }
+}
+
+class ActuatorControllerTests : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      const double gear_ratios[] = {272.22, 762.22, 1742.22, 272.22, 1462.222};
+      const bool is_x8[] = {false, false, false, true, true};
+      for (size_t k = 0; k < joint_count; ++k) {
+        TemperatureModel temperature =
+          is_x8[k] ? TemperatureModel::createX8() : TemperatureModel::createX5();
+        controller.addJoint(gear_ratios[k], is_x8[k], temperature);
+        reference.emplace_back(gear_ratios[k], is_x8[k]);
+      }
+      command_indices.resize(joint_count);
+      for (size_t k = 0; k < joint_count; ++k)
+        command_indices[k] = k;
+    }
+
+    // Sets the command on both controllers; "reference_command" and
+    // "reference_settings" are used by the reference until the next command
+    void setCommand(const CommandMsg& command, const SettingsMsg& settings) {
+      controller.setCommand(command, settings, command_indices, ros::Time());
+      ASSERT_TRUE(controller.acquireCommand());
+      reference_command = command;
+      reference_settings = settings;
+    }
+
+    // Steps both controllers at the given measured state, and checks that
+    // their forces and temperatures agree
+    void step(const std::vector<double>& position, const std::vector<double>& velocity,
+      const std::vector<double>& effort, double dt) {
+
+      controller.position = position;
+      controller.velocity = velocity;
+      controller.effort = effort;
+      controller.update(dt);
+
+      for (size_t k = 0; k < joint_count; ++k) {
+        double force = referenceForce(reference_command, reference_settings, reference[k],
+          command_indices[k], position[k], velocity[k], effort[k], dt);
+        EXPECT_EQ(force, controller.force[k]) << "joint " << k << ", dt " << dt;
+        EXPECT_DOUBLE_EQ(reference[k].temperature.getMotorWindingTemperature(),
+          controller.winding_temperature[k]) << "joint " << k;
+        EXPECT_DOUBLE_EQ(reference[k].temperature.getMotorHousingTemperature(),
+          controller.housing_temperature[k]) << "joint " << k;
+        EXPECT_DOUBLE_EQ(reference[k].temperature.getActuatorBodyTemperature(),
+          controller.body_temperature[k]) << "joint " << k;
+      }
+    }
+
+    static constexpr size_t joint_count = 5;
+    ActuatorController controller;
+    std::vector<ReferenceJoint> reference;
+    std::vector<int> command_indices;
+    CommandMsg reference_command;
+    SettingsMsg reference_settings;
+};
+
+constexpr size_t ActuatorControllerTests::joint_count;
+
+// Random commands and measured states, with every control strategy, commands
+// that leave out targets, joints in any order within the command, and
+// iterations of zero length
+TEST_F(ActuatorControllerTests, ForcesMatchReference) {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> state(-1, 1);
+  std::uniform_int_distribution<int> strategy(0, 5);
+  std::uniform_int_distribution<int> target_count(joint_count - 2, joint_count);
+  const double dts[] = {0.001, 0.0, 0.01, 0.0025};
+
+  std::vector<double> position(joint_count);
+  std::vector<double> velocity(joint_count);
+  std::vector<double> effort(joint_count);
+
+  for (int iteration = 0; iteration < 2000; ++iteration) {
+    if (iteration % 20 == 0) {
+      std::shuffle(command_indices.begin(), command_indices.end(), generator);
+
+      CommandMsg command;
+      command.position.resize(target_count(generator));
+      command.velocity.resize(target_count(generator));
+      command.effort.resize(target_count(generator));
+      for (double& value : command.position)
+        value = state(generator) * 3;
+      for (double& value : command.velocity)
+        value = state(generator);
+      for (double& value : command.effort)
+        value = state(generator) * 2;
+
+      SettingsMsg settings;
+      settings.control_strategy.resize(joint_count);
+      for (auto& value : settings.control_strategy)
+        value = strategy(generator);
+      fillGains(settings.position_gains, joint_count, generator);
+      fillGains(settings.velocity_gains, joint_count, generator);
+      fillGains(settings.effort_gains, joint_count, generator);
+      setCommand(command, settings);
+    }
+
+    for (size_t k = 0; k < joint_count; ++k) {
+      position[k] = state(generator) * 3;
+      velocity[k] = state(generator) * 0.1;
+      effort[k] = state(generator) * 2;
+    }
+    step(position, velocity, effort, dts[iteration % 4]);
+  }
+}
+
+// Stalled joints at full PWM heat up until the temperature safety limit
+// noticeably reduces their PWM, the same way in both controllers
+TEST_F(ActuatorControllerTests, SafetyLimitMatchesReference) {
+  CommandMsg command;
+  command.effort.assign(joint_count, 1);
+  SettingsMsg settings;
+  settings.control_strategy.assign(joint_count, 1);
+  std::mt19937 generator(3);
+  fillGains(settings.position_gains, joint_count, generator);
+  fillGains(settings.velocity_gains, joint_count, generator);
+  fillGains(settings.effort_gains, joint_count, generator);
+  setCommand(command, settings);
+
+  std::vector<double> zeros(joint_count, 0);
+  step(zeros, zeros, zeros, 0.1);
+  std::vector<double> cold_force = controller.force;
+  for (int iteration = 0; iteration < 2000; ++iteration)
+    step(zeros, zeros, zeros, 0.1);
+
+  for (size_t k = 0; k < joint_count; ++k) {
+    EXPECT_GT(controller.safety_limit_count[k], 0u) << "joint " << k;
+    EXPECT_LT(controller.force[k], 0.9 * cold_force[k]) << "joint " << k;
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+#include "ros/package.h"
+#include "sim/hebiros_actuator_settings.h"
+
+using hebiros::sim::ActuatorSettings;
+
+// The default gains that the Gazebo plugin's HebirosGazeboController::
+// SetDefaultGains had built in before they moved to the gains files: kp, ki
+// and kd of position, velocity and effort, by model and control strategy
+struct ReferenceGains {
+  const char* model_name;
+  int control_strategy;
+  double gains[9];
+};
+
+static const ReferenceGains reference_gains[] = {
+  {"X5_1", 2, {5, 0, 0, 0.1, 0, 0, 0.25, 0, 0.001}},
+  {"X5_1", 3, {0.5, 0, 0, 0.05, 0, 0, 0.25, 0, 0.001}},
+  {"X5_1", 4, {5, 0, 0, 0.05, 0, 0, 0.25, 0, 0.001}},
+  {"X5_4", 2, {10, 0, 0, 0.2, 0, 0, 0.25, 0, 0.001}},
+  {"X5_4", 3, {1, 0, 0, 0.05, 0, 0, 0.25, 0, 0.001}},
+  {"X5_4", 4, {10, 0, 0, 0.05, 0, 0, 0.25, 0, 0.001}},
+  {"X5_9", 2, {15, 0, 0, 0.5, 0, 0, 0.25, 0, 0.001}},
+  {"X5_9", 3, {1.5, 0, 0, 0.05, 0, 0, 0.25, 0, 0.001}},
+  {"X5_9", 4, {15, 0, 0, 0.05, 0, 0, 0.25, 0, 0.001}},
+  {"X8_3", 2, {3, 0, 0, 0.1, 0, 0, 0.1, 0, 0.0001}},
+  {"X8_3", 3, {1, 0, 0, 0.03, 0, 0, 0.1, 0, 0.0001}},
+  {"X8_3", 4, {3, 0, 0, 0.03, 0, 0, 0.1, 0, 0.0001}},
+  {"X8_9", 2, {5, 0, 0, 0.1, 0, 0, 0.1, 0, 0.0001}},
+  {"X8_9", 3, {2, 0, 0, 0.03, 0, 0, 0.1, 0, 0.0001}},
+  {"X8_9", 4, {5, 0, 0, 0.03, 0, 0, 0.1, 0, 0.0001}},
+  {"X8_16", 2, {5, 0, 0, 0.1, 0, 0, 0.1, 0, 0.0001}},
+  {"X8_16", 3, {3, 0, 0, 0.03, 0, 0, 0.1, 0, 0.0001}},
+  {"X8_16", 4, {5, 0, 0, 0.03, 0, 0, 0.1, 0, 0.0001}}};
+
+// Gains of other models, and of strategies without a row above
+static const double reference_default_gains[9] = {0.5, 0, 0, 0.05, 0, 0, 0.25, 0, 0.001};
+
+static void expectGains(const double* expected, const ActuatorSettings::Gains& gains) {
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(expected[i], gains.position[i]) << "position " << i;
+    EXPECT_EQ(expected[3 + i], gains.velocity[i]) << "velocity " << i;
+    EXPECT_EQ(expected[6 + i], gains.effort[i]) << "effort " << i;
+  }
+}
+
+static std::string gainsFileName(const std::string& model_name, int control_strategy) {
+  return ros::package::getPath("hebiros") + "/gains/" + model_name + "_strategy" +
+    std::to_string(control_strategy) + ".xml";
+}
+
+static ActuatorSettings::Gains filledGains(double value) {
+  ActuatorSettings::Gains gains;
+  gains.position.fill(value);
+  gains.velocity.fill(value);
+  gains.effort.fill(value);
+  return gains;
+}
+
+// The shipped gains files hold exactly the old built-in gains
+TEST(ActuatorSettingsTests, GainsFilesMatchReference) {
+  for (const ReferenceGains& reference : reference_gains) {
+    std::string file_name = gainsFileName(reference.model_name, reference.control_strategy);
+    SCOPED_TRACE(file_name);
+    int control_strategy = -1;
+    ActuatorSettings::Gains gains = filledGains(-1);
+    ASSERT_TRUE(ActuatorSettings::readGainsFile(file_name, control_strategy, gains));
+    EXPECT_EQ(reference.control_strategy, control_strategy);
+    expectGains(reference.gains, gains);
+  }
+}
+
+// The default gains tables hold the old built-in gains, the default control
+// strategy's gains for strategies without gains of their own, and generic
+// gains for unknown models
+TEST(ActuatorSettingsTests, DefaultGainsMatchReference) {
+  for (const ReferenceGains& reference : reference_gains) {
+    SCOPED_TRACE(std::string(reference.model_name) + " strategy " +
+      std::to_string(reference.control_strategy));
+    const ActuatorSettings::GainsTable& table =
+      ActuatorSettings::getDefaultGains(reference.model_name);
+    expectGains(reference.gains, table[reference.control_strategy]);
+    if (reference.control_strategy == 3) {
+      expectGains(reference.gains, table[0]);
+      expectGains(reference.gains, table[1]);
+    }
+  }
+
+  const ActuatorSettings::GainsTable& table = ActuatorSettings::getDefaultGains("X9_27");
+  for (const ActuatorSettings::Gains& gains : table)
+    expectGains(reference_default_gains, gains);
+}
+
+// Gains files written by the tests, removed at the end of each test
+class GainsFileTests : public ::testing::Test {
+  protected:
+    void TearDown() override {
+      for (const std::string& file_name : file_names)
+        std::remove(file_name.c_str());
+    }
+
+    std::string writeFile(const std::string& contents) {
+      std::string file_name = "/tmp/hebiros_test_gains_" + std::to_string(getpid()) + "_" +
+        std::to_string(file_names.size()) + ".xml";
+      std::ofstream(file_name) << contents;
+      file_names.push_back(file_name);
+      return file_name;
+    }
+
+    std::vector<std::string> file_names;
+};
+
+// Without a gains file, the built-in gains stay
+TEST_F(GainsFileTests, MissingFileKeepsBuiltInGains) {
+  ActuatorSettings::Gains gains = filledGains(7);
+  std::string file_name = "/tmp/hebiros_test_gains_missing_" + std::to_string(getpid()) + ".xml";
+  EXPECT_FALSE(ActuatorSettings::readStrategyGains(file_name, 3, gains));
+  double expected[9] = {7, 7, 7, 7, 7, 7, 7, 7, 7};
+  expectGains(expected, gains);
+
+  int control_strategy = 3;
+  EXPECT_FALSE(ActuatorSettings::readGainsFile(file_name, control_strategy, gains));
+  EXPECT_EQ(3, control_strategy);
+  expectGains(expected, gains);
+}
+
+// A file that is not a gains file is treated as missing
+TEST_F(GainsFileTests, OtherFileKeepsBuiltInGains) {
+  ActuatorSettings::Gains gains = filledGains(7);
+  std::string file_name = writeFile("<robot><kp>1</kp></robot>\n");
+  EXPECT_FALSE(ActuatorSettings::readStrategyGains(file_name, 3, gains));
+  double expected[9] = {7, 7, 7, 7, 7, 7, 7, 7, 7};
+  expectGains(expected, gains);
+}
+
+// The gains of a file for another control strategy are not used, not even
+// partly
+TEST_F(GainsFileTests, MismatchedStrategyKeepsBuiltInGains) {
+  std::ifstream file(gainsFileName("X5_4", 2));
+  std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  ASSERT_FALSE(contents.empty());
+  std::string file_name = writeFile(contents);
+
+  ActuatorSettings::Gains gains = filledGains(7);
+  EXPECT_TRUE(ActuatorSettings::readStrategyGains(file_name, 3, gains));
+  double expected[9] = {7, 7, 7, 7, 7, 7, 7, 7, 7};
+  expectGains(expected, gains);
+
+  EXPECT_TRUE(ActuatorSettings::readStrategyGains(file_name, 2, gains));
+  expectGains(reference_gains[3].gains, gains);
+}
+
+// Only the first module's gains are read, and gains missing from the file
+// stay as they were
+TEST_F(GainsFileTests, ReadsFirstModuleAndKeepsMissingGains) {
+  std::string file_name = writeFile(
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\" ?>\n"
+    "<group_gains>\n"
+    "    <control_strategy>4 4</control_strategy>\n"
+    "    <position>\n"
+    "        <kp>1.5 2.5</kp>\n"
+    "        <kd>0.25 0.5</kd>\n"
+    "    </position>\n"
+    "    <effort>\n"
+    "        <ki>0.125</ki>\n"
+    "    </effort>\n"
+    "</group_gains>\n");
+
+  ActuatorSettings::Gains gains = filledGains(7);
+  EXPECT_TRUE(ActuatorSettings::readStrategyGains(file_name, 4, gains));
+  double expected[9] = {1.5, 7, 0.25, 7, 7, 7, 7, 0.125, 7};
+  expectGains(expected, gains);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
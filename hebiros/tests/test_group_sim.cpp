@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "hebiros_group_sim.h"
+
+// Motor and rotor constants of an X5-1 (see ActuatorController and
+// HebirosGroupSim), from which the response of a joint follows analytically
+static constexpr double gear_ratio = 272.22;
+static constexpr double voltage = 48.0;
+static constexpr double speed_constant = 1530.0;
+static constexpr double term_resist = 9.99;
+static constexpr double rotor_inertia = 6.0e-7;
+static constexpr double rotor_damping = 7.0e-7;
+
+// One link on a joint at the base; "axis" is "0 0 1" for a vertical axis
+// (gravity does not act on the joint) or "0 1 0" for a horizontal one
+static constexpr double link_mass = 0.5;
+static constexpr double link_com = 0.1;
+static constexpr double link_izz = 0.003;
+
+static std::string linkModel(const std::string& axis) {
+  return R"(<?xml version="1.0"?>
+<robot name="link">
+  <link name="world"/>
+  <joint name="world_joint" type="fixed">
+    <origin xyz="0 0 0" rpy="0 0 0"/>
+    <parent link="world"/>
+    <child link="base"/>
+  </joint>
+  <link name="base">
+    <inertial>
+      <origin xyz="0 0 0" rpy="0 0 0"/>
+      <mass value="1.0"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+  <joint name="arm/j1/X5_1" type="revolute">
+    <origin xyz="0 0 0" rpy="0 0 0"/>
+    <axis xyz=")" + axis + R"("/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="base"/>
+    <child link="l1"/>
+  </joint>
+  <link name="l1">
+    <inertial>
+      <origin xyz="0.1 0 0" rpy="0 0 0"/>
+      <mass value="0.5"/>
+      <inertia ixx="0.001" ixy="0" ixz="0" iyy="0.002" iyz="0" izz="0.003"/>
+    </inertial>
+  </link>
+</robot>
+)";
+}
+
+class GroupSimTests : public ::testing::Test {
+  protected:
+    // Sets up the group with one X5-1 joint, without a model if "axis" is
+    // empty, or with the model of one link otherwise
+    void createGroup(const std::string& axis) {
+      group.joints["arm/j1"] = 0;
+      group.joint_full_names["arm/j1"] = "arm/j1/X5_1";
+      group.size = 1;
+      group.initialize();
+      group.setCommandLifetime(0);
+      if (axis.empty())
+        return;
+
+      urdf::Model urdf;
+      ASSERT_TRUE(urdf.initString(linkModel(axis)));
+      model = HebirosModel::fromURDF(urdf);
+      ASSERT_TRUE(model);
+      group.model.reset(new HebirosGroupModel(*model, group));
+      ASSERT_TRUE(group.model->isValid());
+    }
+
+    // Steps the group, and returns the feedback, which holds the state from
+    // before the step
+    const hebiros::FeedbackMsg& step(double dt) {
+      time += ros::Duration(dt);
+      group.step(dt, time);
+      return group.getFeedback();
+    }
+
+    // Under a constant PWM, the motor's force falls linearly with velocity
+    // (back EMF), F = a - b v, so a joint of inertia M with viscous friction c
+    // approaches a / (b + c) with time constant M / (b + c). Checks the
+    // simulated velocity and position against that, for three time constants.
+    void expectConstantPwmResponse(double inertia) {
+      const double pwm = 0.5;
+      hebiros::CommandMsg command_msg;
+      command_msg.name = {"arm/j1"};
+      command_msg.effort = {pwm};
+      command_msg.settings.control_strategy = {1};
+      group.setCommand(command_msg, time);
+
+      const double torque_constant = 0.00626 * gear_ratio * 0.65;
+      const double a = pwm * voltage / term_resist * torque_constant;
+      const double b = gear_ratio / speed_constant / term_resist * torque_constant;
+      const double c = rotor_damping * gear_ratio * gear_ratio;
+      const double final_velocity = a / (b + c);
+      const double time_constant = inertia / (b + c);
+
+      const double dt = 0.0005;
+      const int steps = static_cast<int>(3 * time_constant / dt);
+      for (int k = 0; k <= steps; ++k) {
+        const hebiros::FeedbackMsg& feedback = step(dt);
+        double t = k * dt;
+        double decay = std::exp(-t / time_constant);
+        double velocity = final_velocity * (1 - decay);
+        double position = final_velocity * (t - time_constant * (1 - decay));
+        ASSERT_NEAR(velocity, feedback.velocity[0], 1e-3 * final_velocity) << "t " << t;
+        ASSERT_NEAR(position, feedback.position[0], 1e-3 * final_velocity * time_constant)
+          << "t " << t;
+      }
+    }
+
+    HebirosGroupSim group;
+    std::unique_ptr<HebirosModel> model;
+    ros::Time time;
+};
+
+// Without a model, a joint only moves its actuator's reflected rotor inertia
+TEST_F(GroupSimTests, ConstantPwmMovesRotorInertia) {
+  createGroup("");
+  expectConstantPwmResponse(rotor_inertia * gear_ratio * gear_ratio);
+}
+
+// A link on a vertical axis adds its inertia about the axis to the rotor's
+TEST_F(GroupSimTests, ConstantPwmMovesRotorAndLinkInertia) {
+  createGroup("0 0 1");
+  expectConstantPwmResponse(rotor_inertia * gear_ratio * gear_ratio +
+    link_mass * link_com * link_com + link_izz);
+}
+
+// A link on a horizontal axis, held at zero by the default position control,
+// sags under gravity until the actuator's force balances it, and stays there
+TEST_F(GroupSimTests, LinkHeldAgainstGravitySettles) {
+  createGroup("0 1 0");
+
+  hebiros::CommandMsg command_msg;
+  command_msg.name = {"arm/j1"};
+  command_msg.position = {0};
+  command_msg.velocity = {0};
+  group.setCommand(command_msg, time);
+
+  const double dt = 0.001;
+  for (int k = 0; k < 20000; ++k)
+    step(dt);
+  hebiros::FeedbackMsg settled = step(dt);
+  const hebiros::FeedbackMsg& feedback = step(dt);
+
+  // Rotating about y takes the link's center of mass to (l cos q, 0, -l sin q),
+  // so gravity pulls the joint with m g l cos q
+  double position = feedback.position[0];
+  double gravity_effort = link_mass * 9.81 * link_com * std::cos(position);
+  EXPECT_GT(std::abs(position), 0.01);
+  EXPECT_LT(std::abs(position), 0.5);
+  EXPECT_NEAR(0, feedback.velocity[0], 1e-6);
+  EXPECT_NEAR(settled.position[0], position, 1e-8);
+  EXPECT_NEAR(-gravity_effort, feedback.effort[0], 1e-4 * gravity_effort);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "hebiros_group.h"
+#include "hebiros_group_model.h"
+#include "hebiros_model.h"
+
+// A pedestal (a vertical cylinder) carrying a planar arm of three links, each
+// a cylinder along its x axis. The first two links move in the pedestal's top
+// plane; the third is lifted above them, and carries a rigidly attached tool
+// (a sphere) at its end. Folding the second link back over the first brings
+// it onto the pedestal.
+static const std::string robot = R"(<?xml version="1.0"?>
+<robot name="arm">
+  <link name="world"/>
+  <joint name="world_joint" type="fixed">
+    <origin xyz="0 0 0" rpy="0 0 0"/>
+    <parent link="world"/>
+    <child link="base"/>
+  </joint>
+  <link name="base">
+    <inertial>
+      <origin xyz="0 0 0.1" rpy="0 0 0"/>
+      <mass value="1.0"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+    <collision>
+      <origin xyz="0 0 0.1" rpy="0 0 0"/>
+      <geometry><cylinder length="0.2" radius="0.03"/></geometry>
+    </collision>
+  </link>
+  <joint name="j1" type="revolute">
+    <origin xyz="0 0 0.2" rpy="0 0 0"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="base"/>
+    <child link="l1"/>
+  </joint>
+  <link name="l1">
+    <inertial>
+      <origin xyz="0.15 0 0" rpy="0 0 0"/>
+      <mass value="0.5"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+    <collision>
+      <origin xyz="0.15 0 0" rpy="0 1.5707963267948966 0"/>
+      <geometry><cylinder length="0.3" radius="0.02"/></geometry>
+    </collision>
+  </link>
+  <joint name="j2" type="revolute">
+    <origin xyz="0.3 0 0" rpy="0 0 0"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="l1"/>
+    <child link="l2"/>
+  </joint>
+  <link name="l2">
+    <inertial>
+      <origin xyz="0.15 0 0" rpy="0 0 0"/>
+      <mass value="0.5"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+    <collision>
+      <origin xyz="0.15 0 0" rpy="0 1.5707963267948966 0"/>
+      <geometry><cylinder length="0.3" radius="0.02"/></geometry>
+    </collision>
+  </link>
+  <joint name="j3" type="revolute">
+    <origin xyz="0.3 0 0.1" rpy="0 0 0"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="l2"/>
+    <child link="l3"/>
+  </joint>
+  <link name="l3">
+    <inertial>
+      <origin xyz="0.15 0 0" rpy="0 0 0"/>
+      <mass value="0.5"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+    <collision>
+      <origin xyz="0.15 0 0" rpy="0 1.5707963267948966 0"/>
+      <geometry><cylinder length="0.3" radius="0.02"/></geometry>
+    </collision>
+  </link>
+  <joint name="tool_joint" type="fixed">
+    <origin xyz="0.3 0 0" rpy="0 0 0"/>
+    <parent link="l3"/>
+    <child link="tool"/>
+  </joint>
+  <link name="tool">
+    <inertial>
+      <origin xyz="0 0 0" rpy="0 0 0"/>
+      <mass value="0.1"/>
+      <inertia ixx="0.001" ixy="0" ixz="0" iyy="0.001" iyz="0" izz="0.001"/>
+    </inertial>
+    <collision>
+      <origin xyz="0 0 0" rpy="0 0 0"/>
+      <geometry><sphere radius="0.03"/></geometry>
+    </collision>
+  </link>
+</robot>
+)";
+
+class SelfCollisionTests : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      urdf::Model urdf;
+      ASSERT_TRUE(urdf.initString(robot));
+      model = HebirosModel::fromURDF(urdf);
+      ASSERT_TRUE(model);
+      ASSERT_TRUE(model->hasCapsules());
+      ASSERT_EQ(3u, model->getDoFCount());
+    }
+
+    // Checks for a collision at the given positions; on a collision, the
+    // names of the colliding links are set
+    bool collides(double j1, double j2, double j3) {
+      Eigen::VectorXd positions(3);
+      positions << j1, j2, j3;
+      model->getLinkFrames(positions, output_frames, link_frames, workspace);
+      size_t link_a, link_b;
+      if (!model->findSelfCollision(link_frames, 0.04, points, link_a, link_b))
+        return false;
+      collision_a = model->getLinkNames()[link_a];
+      collision_b = model->getLinkNames()[link_b];
+      return true;
+    }
+
+    // The point x along a link's axis, at the positions last checked
+    Eigen::Vector3d linkPoint(const std::string& link, double x) const {
+      const std::vector<std::string>& link_names = model->getLinkNames();
+      size_t index = std::find(link_names.begin(), link_names.end(), link) - link_names.begin();
+      return (link_frames.at(index) * Eigen::Vector4d(x, 0, 0, 1)).head<3>();
+    }
+
+    std::unique_ptr<HebirosModel> model;
+    hebi::robot_model::Matrix4dVector output_frames;
+    hebi::robot_model::Matrix4dVector link_frames;
+    HebirosModel::FKWorkspace workspace;
+    std::vector<Eigen::Vector3d> points;
+    std::string collision_a;
+    std::string collision_b;
+};
+
+// Stretched out, or with the lifted third link over the first, no links that
+// are checked come near each other
+TEST_F(SelfCollisionTests, ClearPoses) {
+  EXPECT_FALSE(collides(0, 0, 0));
+  EXPECT_FALSE(collides(1.0, -0.5, 2.0));
+  EXPECT_FALSE(collides(0, 2.0, 2.5));
+}
+
+// Folding the second link back over the first puts its end on the pedestal
+TEST_F(SelfCollisionTests, FoldedArmHitsPedestal) {
+  ASSERT_TRUE(collides(0.4, M_PI, 0));
+  EXPECT_EQ("base", collision_a);
+  EXPECT_EQ("l2", collision_b);
+}
+
+// Adjacent links always touch at their joint, and at this pose the second
+// link lies almost on top of the first; the tool is inside the end of the
+// third link. Neither pair is reported, since they are connected by a single
+// joint or rigidly attached.
+TEST_F(SelfCollisionTests, AdjacentAndAttachedLinksAreIgnored) {
+  EXPECT_FALSE(collides(0, 2.9, 0));
+
+  // The middle of the second link is closer to the first link than the sum of
+  // their radii, so this pair would collide if it were checked
+  Eigen::Vector3d l1_start = linkPoint("l1", 0);
+  Eigen::Vector3d l1_end = linkPoint("l1", 0.3);
+  Eigen::Vector3d l2_middle = linkPoint("l2", 0.15);
+  Eigen::Vector3d l1_direction = (l1_end - l1_start).normalized();
+  Eigen::Vector3d offset = l2_middle - l1_start;
+  EXPECT_LT((offset - l1_direction * l1_direction.dot(offset)).norm(), 0.02 + 0.02);
+}
+
+// Trajectories are checked at every sample, not only at their waypoints
+TEST_F(SelfCollisionTests, TrajectorySweepFindsCollisionBetweenWaypoints) {
+  HebirosGroup group;
+  group.size = 3;
+  group.joints = {{"j1", 0}, {"j2", 1}, {"j3", 2}};
+  HebirosGroupModel group_model(*model, group);
+  ASSERT_TRUE(group_model.isValid());
+
+  // The second joint swings from one side of the fold to the other, through
+  // the colliding pose at pi
+  Eigen::VectorXd times(2);
+  times << 0, 1;
+  Eigen::MatrixXd positions(3, 2);
+  positions << 0, 0,
+               2.9, 2 * M_PI - 2.9,
+               0, 0;
+  auto trajectory = hebi::trajectory::Trajectory::createUnconstrainedQp(times, positions);
+  ASSERT_TRUE(trajectory);
+  EXPECT_FALSE(collides(0, 2.9, 0));
+  EXPECT_FALSE(collides(0, 2 * M_PI - 2.9, 0));
+
+  std::string collision;
+  EXPECT_FALSE(group_model.checkTrajectory(*trajectory, 0.01, 0.04, collision));
+  EXPECT_NE(std::string::npos, collision.find("links base and l2")) << collision;
+
+  // Sampling only the ends misses it
+  collision.clear();
+  EXPECT_TRUE(group_model.checkTrajectory(*trajectory, 2.0, 0.04, collision)) << collision;
+
+  // A trajectory that stays clear passes
+  positions << 0, 1,
+               0, 0.5,
+               0, -1;
+  trajectory = hebi::trajectory::Trajectory::createUnconstrainedQp(times, positions);
+  ASSERT_TRUE(trajectory);
+  EXPECT_TRUE(group_model.checkTrajectory(*trajectory, 0.01, 0.04, collision)) << collision;
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
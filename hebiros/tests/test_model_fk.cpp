@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include "hebiros_model.h"
+
+// A base and a link that branches into two leaf links, and the serial models
+// along each branch. The links and joints are the same in all three, so the
+// frames of each branch of the tree have to match those of its serial model.
+static const std::string robot_begin = R"(<?xml version="1.0"?>
+<robot name="tree">
+  <link name="world"/>
+  <joint name="world_joint" type="fixed">
+    <origin xyz="0 0 0" rpy="0 0 0"/>
+    <parent link="world"/>
+    <child link="base"/>
+  </joint>
+  <link name="base">
+    <inertial>
+      <origin xyz="0.01 0 0.02" rpy="0 0 0"/>
+      <mass value="1.0"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+  <joint name="joint_a" type="revolute">
+    <origin xyz="0 0 0.1" rpy="0 0 0.3"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="base"/>
+    <child link="link_a"/>
+  </joint>
+  <link name="link_a">
+    <inertial>
+      <origin xyz="0.05 0 0" rpy="0 0.1 0"/>
+      <mass value="0.5"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+)";
+
+static const std::string branch_b = R"(
+  <joint name="joint_b" type="revolute">
+    <origin xyz="0.2 0.05 0" rpy="0.2 0 0"/>
+    <axis xyz="0 1 0"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="link_a"/>
+    <child link="link_b"/>
+  </joint>
+  <link name="link_b">
+    <inertial>
+      <origin xyz="0.1 0 0" rpy="0 0 0"/>
+      <mass value="0.3"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+)";
+
+static const std::string branch_c = R"(
+  <joint name="joint_c" type="revolute">
+    <origin xyz="0.2 -0.05 0" rpy="0 0 -0.4"/>
+    <axis xyz="1 0 0"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="link_a"/>
+    <child link="link_c"/>
+  </joint>
+  <link name="link_c">
+    <inertial>
+      <origin xyz="0 0 0.1" rpy="0 0 0"/>
+      <mass value="0.2"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+)";
+
+static const std::string robot_end = "</robot>\n";
+
+static std::unique_ptr<HebirosModel> modelFromString(const std::string& description) {
+  urdf::Model urdf;
+  if (!urdf.initString(description))
+    return nullptr;
+  return HebirosModel::fromURDF(urdf);
+}
+
+// The HEBI robot model computes frames in single precision
+static void expectFrameNear(const Eigen::Matrix4d& expected, const Eigen::Matrix4d& actual) {
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR(expected(i, j), actual(i, j), 1e-6) << "at (" << i << ", " << j << ")";
+}
+
+class TreeFKTests : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      tree = modelFromString(robot_begin + branch_b + branch_c + robot_end);
+      serial_b = modelFromString(robot_begin + branch_b + robot_end);
+      serial_c = modelFromString(robot_begin + branch_c + robot_end);
+      ASSERT_TRUE(tree && serial_b && serial_c);
+      ASSERT_FALSE(tree->isChain());
+      ASSERT_TRUE(serial_b->isChain());
+      ASSERT_TRUE(serial_c->isChain());
+      ASSERT_EQ(3u, tree->getDoFCount());
+    }
+
+    std::unique_ptr<HebirosModel> tree;
+    std::unique_ptr<HebirosModel> serial_b;
+    std::unique_ptr<HebirosModel> serial_c;
+};
+
+// Joints are in depth-first order: joint_a, joint_b, joint_c. The tree
+// reports the base and the branching link once, then each branch.
+TEST_F(TreeFKTests, CenterOfMassFramesMatchSerialModels) {
+  Eigen::VectorXd positions(3);
+  Eigen::VectorXd positions_b(2);
+  Eigen::VectorXd positions_c(2);
+  hebi::robot_model::Matrix4dVector tree_frames;
+  hebi::robot_model::Matrix4dVector frames_b;
+  hebi::robot_model::Matrix4dVector frames_c;
+  HebirosModel::FKWorkspace workspace;
+
+  for (double t : {0.0, 0.7, -2.1, 3.0}) {
+    positions << t, 0.5 - t, 1.3 * t;
+    positions_b << positions[0], positions[1];
+    positions_c << positions[0], positions[2];
+
+    tree->getFK(HebiFrameTypeCenterOfMass, positions, tree_frames, workspace);
+    serial_b->getFK(HebiFrameTypeCenterOfMass, positions_b, frames_b);
+    serial_c->getFK(HebiFrameTypeCenterOfMass, positions_c, frames_c);
+    ASSERT_EQ(4u, tree_frames.size());
+    ASSERT_EQ(3u, frames_b.size());
+    ASSERT_EQ(3u, frames_c.size());
+
+    expectFrameNear(frames_b[0], tree_frames[0]);
+    expectFrameNear(frames_c[0], tree_frames[0]);
+    expectFrameNear(frames_b[1], tree_frames[1]);
+    expectFrameNear(frames_c[1], tree_frames[1]);
+    expectFrameNear(frames_b[2], tree_frames[2]);
+    expectFrameNear(frames_c[2], tree_frames[3]);
+  }
+}
+
+// The leaf links end each branch, so the last output frame of each branch is
+// the end effector of its serial model
+TEST_F(TreeFKTests, BranchEndsMatchSerialModels) {
+  Eigen::VectorXd positions(3);
+  positions << -0.4, 1.1, 0.25;
+  Eigen::VectorXd positions_b(2);
+  positions_b << positions[0], positions[1];
+  Eigen::VectorXd positions_c(2);
+  positions_c << positions[0], positions[2];
+
+  hebi::robot_model::Matrix4dVector tree_frames;
+  tree->getFK(HebiFrameTypeOutput, positions, tree_frames);
+  ASSERT_EQ(tree->getFrameCount(HebiFrameTypeOutput), tree_frames.size());
+
+  size_t branch_c_frames = serial_c->getFrameCount(HebiFrameTypeOutput) -
+    tree->getChains()[0].model->getFrameCount(HebiFrameTypeOutput);
+
+  Eigen::Matrix4d end_b;
+  serial_b->getModel().getEndEffector(positions_b, end_b);
+  Eigen::Matrix4d end_c;
+  serial_c->getModel().getEndEffector(positions_c, end_c);
+  expectFrameNear(end_b, tree_frames[tree_frames.size() - branch_c_frames - 1]);
+  expectFrameNear(end_c, tree_frames.back());
+}
+
+// Reusing a workspace and frames across frame types gives the same frames as
+// computing them afresh
+TEST_F(TreeFKTests, WorkspaceIsReusable) {
+  Eigen::VectorXd positions(3);
+  positions << 0.2, -0.3, 0.4;
+  hebi::robot_model::Matrix4dVector frames;
+  hebi::robot_model::Matrix4dVector reused_frames;
+  HebirosModel::FKWorkspace workspace;
+
+  tree->getFK(HebiFrameTypeCenterOfMass, positions, frames);
+  tree->getFK(HebiFrameTypeOutput, positions, reused_frames, workspace);
+  tree->getFK(HebiFrameTypeCenterOfMass, positions, reused_frames, workspace);
+  ASSERT_EQ(frames.size(), reused_frames.size());
+  for (size_t i = 0; i < frames.size(); ++i)
+    expectFrameNear(frames[i], reused_frames[i]);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "hebiros_model.h"
+
+// An arm with the layout HebirosAnalyticIK supports: a base joint, parallel
+// shoulder and elbow joints offset sideways from the base axis, and a wrist
+// whose axes meet in one point, followed by a tool link. The last wrist joint
+// is optional, for the 5 DoF variant.
+static const std::string arm_begin = R"(<?xml version="1.0"?>
+<robot name="arm">
+  <link name="world"/>
+  <joint name="world_joint" type="fixed">
+    <origin xyz="0 0 0" rpy="0 0 0"/>
+    <parent link="world"/>
+    <child link="base"/>
+  </joint>
+  <link name="base">
+    <inertial>
+      <origin xyz="0 0 0.02" rpy="0 0 0"/>
+      <mass value="1.0"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+  <joint name="j1" type="revolute">
+    <origin xyz="0 0 0.1" rpy="0 0 0"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="base"/>
+    <child link="l1"/>
+  </joint>
+  <link name="l1">
+    <inertial>
+      <origin xyz="0 0 0.03" rpy="0 0 0"/>
+      <mass value="0.5"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+  <joint name="j2" type="revolute">
+    <origin xyz="0 0.05 0.05" rpy="0 0 0"/>
+    <axis xyz="0 1 0"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="l1"/>
+    <child link="l2"/>
+  </joint>
+  <link name="l2">
+    <inertial>
+      <origin xyz="0.15 0 0" rpy="0 0 0"/>
+      <mass value="0.5"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+  <joint name="j3" type="revolute">
+    <origin xyz="0.3 0 0.02" rpy="0 0 0"/>
+    <axis xyz="0 1 0"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="l2"/>
+    <child link="l3"/>
+  </joint>
+  <link name="l3">
+    <inertial>
+      <origin xyz="0.12 0 0" rpy="0 0 0"/>
+      <mass value="0.4"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+  <joint name="j4" type="revolute">
+    <origin xyz="0.25 0 0" rpy="0 0 0"/>
+    <axis xyz="1 0 0"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="l3"/>
+    <child link="l4"/>
+  </joint>
+  <link name="l4">
+    <inertial>
+      <origin xyz="0 0 0" rpy="0 0 0"/>
+      <mass value="0.2"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+  <joint name="j5" type="revolute">
+    <origin xyz="0 0 0" rpy="0 0 0"/>
+    <axis xyz="0 1 0"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="l4"/>
+    <child link="l5"/>
+  </joint>
+  <link name="l5">
+    <inertial>
+      <origin xyz="0 0 0" rpy="0 0 0"/>
+      <mass value="0.2"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+)";
+
+static const std::string last_wrist_joint = R"(
+  <joint name="j6" type="revolute">
+    <origin xyz="0 0 0" rpy="0 0 0"/>
+    <axis xyz="1 0 0"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="l5"/>
+    <child link="l6"/>
+  </joint>
+  <link name="l6">
+    <inertial>
+      <origin xyz="0 0 0" rpy="0 0 0"/>
+      <mass value="0.2"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+  <joint name="tool_joint" type="fixed">
+    <origin xyz="0.08 0 0" rpy="0 0.3 0"/>
+    <parent link="l6"/>
+    <child link="tool"/>
+  </joint>
+)";
+
+static const std::string five_dof_tool = R"(
+  <joint name="tool_joint" type="fixed">
+    <origin xyz="0.08 0 0" rpy="0 0.3 0"/>
+    <parent link="l5"/>
+    <child link="tool"/>
+  </joint>
+)";
+
+static const std::string arm_end = R"(
+  <link name="tool">
+    <inertial>
+      <origin xyz="0 0 0" rpy="0 0 0"/>
+      <mass value="0.1"/>
+      <inertia ixx="0.001" ixy="0" ixz="0" iyy="0.001" iyz="0" izz="0.001"/>
+    </inertial>
+  </link>
+</robot>
+)";
+
+static std::unique_ptr<HebirosModel> modelFromString(const std::string& description) {
+  urdf::Model urdf;
+  if (!urdf.initString(description))
+    return nullptr;
+  return HebirosModel::fromURDF(urdf);
+}
+
+// End effector frame of the model itself (rather than of the solver's own
+// kinematics)
+static Eigen::Matrix4d endEffector(const HebirosModel& model, const Eigen::VectorXd& positions) {
+  hebi::robot_model::Matrix4dVector frames;
+  model.getFK(HebiFrameTypeOutput, positions, frames);
+  return frames.back();
+}
+
+// The HEBI robot model computes frames in single precision
+static void expectFrameNear(const Eigen::Matrix4d& expected, const Eigen::Matrix4d& actual) {
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR(expected(i, j), actual(i, j), 1e-5) << "at (" << i << ", " << j << ")";
+}
+
+// Solves for the end effector frames at random positions; every solution has
+// to reproduce the target, and one of them has to be the positions the target
+// came from.
+static void checkRandomTargets(const HebirosModel& model) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-M_PI, M_PI);
+  size_t dof_count = model.getDoFCount();
+  Eigen::VectorXd positions(dof_count);
+  std::vector<Eigen::VectorXd> solutions;
+
+  for (int i = 0; i < 50; ++i) {
+    for (size_t j = 0; j < dof_count; ++j)
+      positions[j] = distribution(generator);
+    Eigen::Matrix4d target = endEffector(model, positions);
+
+    bool analytic;
+    ASSERT_TRUE(model.solveIK(target, Eigen::VectorXd::Zero(dof_count), solutions, analytic));
+    ASSERT_TRUE(analytic);
+    ASSERT_FALSE(solutions.empty());
+
+    bool found = false;
+    for (auto& solution : solutions) {
+      ASSERT_EQ(dof_count, solution.size());
+      expectFrameNear(target, endEffector(model, solution));
+      Eigen::VectorXd difference = solution - positions;
+      for (size_t j = 0; j < dof_count; ++j)
+        difference[j] = std::remainder(difference[j], 2 * M_PI);
+      found = found || difference.norm() < 1e-4;
+    }
+    EXPECT_TRUE(found) << "target " << i << " did not give back its positions";
+  }
+}
+
+TEST(AnalyticIKTests, SixDoFSolutionsReproduceTarget) {
+  auto model = modelFromString(arm_begin + last_wrist_joint + arm_end);
+  ASSERT_TRUE(model);
+  ASSERT_EQ(6u, model->getDoFCount());
+  ASSERT_TRUE(HebirosAnalyticIK::create(*model));
+  checkRandomTargets(*model);
+}
+
+TEST(AnalyticIKTests, FiveDoFSolutionsReproduceTarget) {
+  auto model = modelFromString(arm_begin + five_dof_tool + arm_end);
+  ASSERT_TRUE(model);
+  ASSERT_EQ(5u, model->getDoFCount());
+  ASSERT_TRUE(HebirosAnalyticIK::create(*model));
+  checkRandomTargets(*model);
+}
+
+// The solver's own kinematics agree with the model's
+TEST(AnalyticIKTests, EndEffectorMatchesModel) {
+  auto model = modelFromString(arm_begin + last_wrist_joint + arm_end);
+  ASSERT_TRUE(model);
+  auto ik = HebirosAnalyticIK::create(*model);
+  ASSERT_TRUE(ik);
+
+  Eigen::VectorXd positions(6);
+  positions << 0.3, -1.2, 2.0, 0.7, -0.4, 2.9;
+  expectFrameNear(endEffector(*model, positions), ik->getEndEffector(positions));
+}
+
+// A target out of reach has no exact solution
+TEST(AnalyticIKTests, UnreachableTargetHasNoSolution) {
+  auto model = modelFromString(arm_begin + last_wrist_joint + arm_end);
+  ASSERT_TRUE(model);
+  auto ik = HebirosAnalyticIK::create(*model);
+  ASSERT_TRUE(ik);
+
+  Eigen::Matrix4d target = Eigen::Matrix4d::Identity();
+  target(0, 3) = 2.0;
+  std::vector<Eigen::VectorXd> solutions;
+  EXPECT_FALSE(ik->solve(target, solutions));
+  EXPECT_TRUE(solutions.empty());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+#include "hebiros_model.h"
+
+// A base and a link that branches into two leaf links, with collision
+// geometry of each supported kind, so the snapshot holds more than one chain
+// and capsules of each shape.
+static const std::string robot = R"(<?xml version="1.0"?>
+<robot name="tree">
+  <link name="world"/>
+  <joint name="world_joint" type="fixed">
+    <origin xyz="0 0 0.05" rpy="0 0 0.2"/>
+    <parent link="world"/>
+    <child link="base"/>
+  </joint>
+  <link name="base">
+    <inertial>
+      <origin xyz="0.01 0 0.02" rpy="0 0 0"/>
+      <mass value="1.0"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+    <collision>
+      <origin xyz="0 0 0.02" rpy="0 0 0"/>
+      <geometry><box size="0.1 0.1 0.04"/></geometry>
+    </collision>
+  </link>
+  <joint name="joint_a" type="revolute">
+    <origin xyz="0 0 0.1" rpy="0 0 0.3"/>
+    <axis xyz="0 0 1"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="base"/>
+    <child link="link_a"/>
+  </joint>
+  <link name="link_a">
+    <inertial>
+      <origin xyz="0.05 0 0" rpy="0 0.1 0"/>
+      <mass value="0.5"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+    <collision>
+      <origin xyz="0.1 0 0" rpy="0 1.5708 0"/>
+      <geometry><cylinder length="0.2" radius="0.02"/></geometry>
+    </collision>
+  </link>
+  <joint name="joint_b" type="revolute">
+    <origin xyz="0.2 0.05 0" rpy="0.2 0 0"/>
+    <axis xyz="0 1 0"/>
+    <limit lower="-3.14" upper="3.14" effort="10" velocity="10"/>
+    <parent link="link_a"/>
+    <child link="link_b"/>
+  </joint>
+  <link name="link_b">
+    <inertial>
+      <origin xyz="0.1 0 0" rpy="0 0 0"/>
+      <mass value="0.3"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+    <collision>
+      <origin xyz="0.1 0 0" rpy="0 0 0"/>
+      <geometry><sphere radius="0.03"/></geometry>
+    </collision>
+  </link>
+  <joint name="joint_c" type="prismatic">
+    <origin xyz="0.2 -0.05 0" rpy="0 0 -0.4"/>
+    <axis xyz="1 0 0"/>
+    <limit lower="0" upper="0.1" effort="10" velocity="10"/>
+    <parent link="link_a"/>
+    <child link="link_c"/>
+  </joint>
+  <link name="link_c">
+    <inertial>
+      <origin xyz="0 0 0.1" rpy="0 0 0"/>
+      <mass value="0.2"/>
+      <inertia ixx="0.01" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="0.01"/>
+    </inertial>
+  </link>
+</robot>
+)";
+
+static const uint64_t hash = 0x0123456789abcdefull;
+
+template <size_t N>
+static void expectArrayEq(const double (&expected)[N], const double (&actual)[N]) {
+  for (size_t i = 0; i < N; ++i)
+    EXPECT_EQ(expected[i], actual[i]) << "at " << i;
+}
+
+class ModelSnapshotTests : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      urdf::Model urdf;
+      ASSERT_TRUE(urdf.initString(robot));
+      model = HebirosModel::fromURDF(urdf);
+      ASSERT_TRUE(model);
+      ASSERT_GT(model->getChains().size(), 1u);
+
+      char name[] = "/tmp/hebiros_snapshot_XXXXXX";
+      int fd = mkstemp(name);
+      ASSERT_NE(-1, fd);
+      close(fd);
+      file = name;
+    }
+
+    void TearDown() override {
+      if (!file.empty())
+        std::remove(file.c_str());
+    }
+
+    std::unique_ptr<HebirosModel> model;
+    std::string file;
+};
+
+// Everything the snapshot stores reads back exactly as it was written
+TEST_F(ModelSnapshotTests, RoundTripIsEqual) {
+  const std::vector<HebirosModel::Chain>& written = model->getChains();
+  ASSERT_TRUE(HebirosModel::writeSnapshot(file, hash, written, model->getBaseName()));
+
+  std::vector<HebirosModel::Chain> read;
+  std::string base_name;
+  ASSERT_TRUE(HebirosModel::readSnapshot(file, hash, read, base_name));
+  EXPECT_EQ(model->getBaseName(), base_name);
+  ASSERT_EQ(written.size(), read.size());
+
+  size_t num_capsules = 0;
+  for (size_t i = 0; i < written.size(); ++i) {
+    SCOPED_TRACE("chain " + std::to_string(i));
+    const HebirosModel::Chain& expected = written[i];
+    const HebirosModel::Chain& actual = read[i];
+    EXPECT_EQ(expected.parent, actual.parent);
+    EXPECT_EQ(expected.has_children, actual.has_children);
+    expectArrayEq(expected.base_frame, actual.base_frame);
+    EXPECT_EQ(expected.element_names, actual.element_names);
+
+    ASSERT_EQ(expected.elements.size(), actual.elements.size());
+    for (size_t j = 0; j < expected.elements.size(); ++j) {
+      SCOPED_TRACE("element " + expected.element_names[j]);
+      const HebirosModel::Element& expected_element = expected.elements[j];
+      const HebirosModel::Element& actual_element = actual.elements[j];
+      EXPECT_EQ(expected_element.type, actual_element.type);
+      if (expected_element.type == HebirosModel::Element::Type::Joint)
+        EXPECT_EQ(expected_element.joint_type, actual_element.joint_type);
+      expectArrayEq(expected_element.com, actual_element.com);
+      expectArrayEq(expected_element.inertia, actual_element.inertia);
+      EXPECT_EQ(expected_element.mass, actual_element.mass);
+      expectArrayEq(expected_element.output, actual_element.output);
+    }
+
+    ASSERT_EQ(expected.capsules.size(), actual.capsules.size());
+    for (size_t j = 0; j < expected.capsules.size(); ++j) {
+      const HebirosModel::Capsule& expected_capsule = expected.capsules[j];
+      const HebirosModel::Capsule& actual_capsule = actual.capsules[j];
+      EXPECT_EQ(expected_capsule.element, actual_capsule.element);
+      expectArrayEq(expected_capsule.a, actual_capsule.a);
+      expectArrayEq(expected_capsule.b, actual_capsule.b);
+      EXPECT_EQ(expected_capsule.radius, actual_capsule.radius);
+    }
+    num_capsules += expected.capsules.size();
+  }
+  EXPECT_EQ(3u, num_capsules);
+}
+
+// A snapshot of a different description is not used
+TEST_F(ModelSnapshotTests, HashMismatchIsRejected) {
+  ASSERT_TRUE(HebirosModel::writeSnapshot(file, hash, model->getChains(), model->getBaseName()));
+
+  std::vector<HebirosModel::Chain> read;
+  std::string base_name;
+  EXPECT_FALSE(HebirosModel::readSnapshot(file, hash + 1, read, base_name));
+  EXPECT_TRUE(read.empty());
+}
+
+// A snapshot cut short anywhere is rejected rather than partially read
+TEST_F(ModelSnapshotTests, TruncatedSnapshotIsRejected) {
+  ASSERT_TRUE(HebirosModel::writeSnapshot(file, hash, model->getChains(), model->getBaseName()));
+
+  std::string contents;
+  {
+    std::ifstream in(file, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  ASSERT_FALSE(contents.empty());
+
+  for (size_t size = 0; size < contents.size(); size += 7) {
+    {
+      std::ofstream out(file, std::ios::binary | std::ios::trunc);
+      out.write(contents.data(), size);
+    }
+    std::vector<HebirosModel::Chain> read;
+    std::string base_name;
+    EXPECT_FALSE(HebirosModel::readSnapshot(file, hash, read, base_name)) << "at size " << size;
+    EXPECT_TRUE(read.empty());
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
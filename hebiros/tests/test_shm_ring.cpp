@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include "std_msgs/String.h"
+#include "std_msgs/UInt32.h"
+#include "sim/hebiros_shm_ring.h"
+
+using hebiros::sim::ShmRing;
+
+// Slots hold a serialized std_msgs/String: its length, then its characters
+static constexpr uint32_t slot_count = 4;
+static constexpr uint32_t slot_size = 32;
+static constexpr size_t max_length = slot_size - sizeof(uint32_t);
+
+static std_msgs::String message(const std::string& data) {
+  std_msgs::String message;
+  message.data = data;
+  return message;
+}
+
+// A ring owned by the writer, and the reader's handle to it, as the Gazebo
+// plugin and the node would have them
+class ShmRingTests : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      name = "/hebiros_test_ring_" + std::to_string(getpid());
+      writer = ShmRing::create(name, slot_count, slot_size);
+      ASSERT_TRUE(writer);
+      reader = ShmRing::open(name);
+      ASSERT_TRUE(reader);
+      reader->attachReader(true);
+      ASSERT_TRUE(writer->hasReader());
+    }
+
+    std::string name;
+    std::unique_ptr<ShmRing> writer;
+    std::unique_ptr<ShmRing> reader;
+};
+
+TEST_F(ShmRingTests, EmptyRingHasNothingToRead) {
+  std_msgs::String read;
+  EXPECT_FALSE(reader->read(read));
+}
+
+// A message has to fit in a slot along with its own length field
+TEST_F(ShmRingTests, RejectsMessageLargerThanSlot) {
+  EXPECT_FALSE(writer->write(message(std::string(max_length + 1, 'x'))));
+  ASSERT_TRUE(writer->write(message(std::string(max_length, 'y'))));
+
+  std_msgs::String read;
+  ASSERT_TRUE(reader->read(read));
+  EXPECT_EQ(std::string(max_length, 'y'), read.data);
+  EXPECT_FALSE(reader->read(read));
+}
+
+// Writes fail once every slot holds an unread message, and succeed again
+// once the reader frees slots; messages come out in order across many trips
+// around the ring
+TEST_F(ShmRingTests, WrapsAroundAndDetectsFull) {
+  int written = 0;
+  int read_count = 0;
+  std_msgs::String read;
+
+  for (int round = 0; round < 3 * slot_count; ++round) {
+    while (written - read_count < static_cast<int>(slot_count))
+      ASSERT_TRUE(writer->write(message(std::to_string(written++))));
+    EXPECT_FALSE(writer->write(message("full")));
+
+    // Read one more message each round (up to a full ring), so the full and
+    // partially full ring both start at every slot
+    for (int i = 0; i <= round % slot_count; ++i) {
+      ASSERT_TRUE(reader->read(read));
+      EXPECT_EQ(std::to_string(read_count++), read.data);
+    }
+  }
+
+  while (read_count < written) {
+    ASSERT_TRUE(reader->read(read));
+    EXPECT_EQ(std::to_string(read_count++), read.data);
+  }
+  EXPECT_FALSE(reader->read(read));
+  EXPECT_GT(written, static_cast<int>(2 * slot_count));
+}
+
+// A message that runs past the end of its slot is dropped instead of
+// throwing, and the messages after it still come through
+TEST_F(ShmRingTests, DropsMessageOverrunningSlot) {
+  // Read as a string, this is a length of 1000 with no characters after it
+  std_msgs::UInt32 length;
+  length.data = 1000;
+  ASSERT_TRUE(writer->write(length));
+  ASSERT_TRUE(writer->write(message("after")));
+
+  std_msgs::String read;
+  EXPECT_FALSE(reader->read(read));
+  ASSERT_TRUE(reader->read(read));
+  EXPECT_EQ("after", read.data);
+  EXPECT_FALSE(reader->read(read));
+}
+
+// A reader that attaches only sees what is written after it attached
+TEST_F(ShmRingTests, AttachDropsEarlierMessages) {
+  ASSERT_TRUE(writer->write(message("old")));
+  reader->attachReader(true);
+  ASSERT_TRUE(writer->write(message("new")));
+
+  std_msgs::String read;
+  ASSERT_TRUE(reader->read(read));
+  EXPECT_EQ("new", read.data);
+  EXPECT_FALSE(reader->read(read));
+}
+
+// Once the owner is gone the ring cannot be opened, and the other side's
+// handle reports no reader
+TEST_F(ShmRingTests, OwnerRemovesRing) {
+  writer.reset();
+  EXPECT_FALSE(reader->hasReader());
+  EXPECT_FALSE(ShmRing::open(name));
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
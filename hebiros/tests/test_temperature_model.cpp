@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "sim/hebiros_temperature_model.h"
+
+using hebiros::sim::TemperatureModel;
+
+// Temperatures of the winding, housing and body
+struct Temperatures {
+  double t_w;
+  double t_h;
+  double t_b;
+};
+
+// Integrates the model's heat flow equations over dt with many explicit Euler
+// substeps, each short compared to the winding's time constant
+static Temperatures integrateEuler(const TemperatureModel::Parameters& params,
+  Temperatures t, double power_in, double dt) {
+
+  const double t_e = TemperatureModel::t_e_;
+  size_t substeps = std::max<size_t>(1, std::ceil(dt / 1e-5));
+  double h = dt / substeps;
+  for (size_t i = 0; i < substeps; ++i) {
+    double q_wh = (t.t_w - t.t_h) / params.r_wh;
+    double q_hb = (t.t_h - t.t_b) / params.r_hb;
+    double q_be = (t.t_b - t_e) / params.r_be;
+    t.t_w += h * (power_in - q_wh) / params.c_w;
+    t.t_h += h * (q_wh - q_hb) / params.c_h;
+    t.t_b += h * (q_hb - q_be) / params.c_b;
+  }
+  return t;
+}
+
+static Temperatures temperatures(const TemperatureModel& model) {
+  return {model.getMotorWindingTemperature(), model.getMotorHousingTemperature(),
+    model.getActuatorBodyTemperature()};
+}
+
+static void expectTemperaturesNear(const Temperatures& expected, const Temperatures& actual,
+  double tolerance) {
+  EXPECT_NEAR(expected.t_w, actual.t_w, tolerance);
+  EXPECT_NEAR(expected.t_h, actual.t_h, tolerance);
+  EXPECT_NEAR(expected.t_b, actual.t_b, tolerance);
+}
+
+class TemperatureModelTests : public ::testing::TestWithParam<bool> {
+  protected:
+    TemperatureModel createModel() const {
+      return GetParam() ? TemperatureModel::createX8() : TemperatureModel::createX5();
+    }
+};
+
+// One exact step of any length lands where the fine Euler integration does
+TEST_P(TemperatureModelTests, StepMatchesFineEuler) {
+  for (double dt : {0.001, 0.01, 0.1, 1.0, 5.0}) {
+    for (double power_in : {0.0, 20.0, 300.0}) {
+      SCOPED_TRACE("dt " + std::to_string(dt) + ", power " + std::to_string(power_in));
+      TemperatureModel model = createModel();
+      Temperatures expected =
+        integrateEuler(model.getParameters(), temperatures(model), power_in, dt);
+      model.update(power_in, dt);
+      // Euler's error grows with the rise in temperature (the winding is
+      // hottest)
+      double rise = expected.t_w - TemperatureModel::t_e_;
+      expectTemperaturesNear(expected, temperatures(model), 1e-5 * std::max(1.0, rise));
+    }
+  }
+}
+
+// A run of steps with changing power follows the Euler integration, and the
+// batched update of several actuators gives the same result
+TEST_P(TemperatureModelTests, RunMatchesFineEuler) {
+  TemperatureModel model = createModel();
+  const TemperatureModel::Parameters& params = model.getParameters();
+  Temperatures expected = temperatures(model);
+
+  const double dt = 0.01;
+  TemperatureModel::Step step = TemperatureModel::discretize(params, dt);
+  double t_w[2] = {expected.t_w, expected.t_w};
+  double t_h[2] = {expected.t_h, expected.t_h};
+  double t_b[2] = {expected.t_b, expected.t_b};
+
+  for (int i = 0; i < 500; ++i) {
+    double power_in = 100.0 * (1 + std::sin(i * 0.05));
+    expected = integrateEuler(params, expected, power_in, dt);
+    model.update(power_in, dt);
+    double power[2] = {power_in, power_in};
+    TemperatureModel::update(step, 2, power, t_w, t_h, t_b);
+  }
+
+  expectTemperaturesNear(expected, temperatures(model), 1e-3);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(model.getMotorWindingTemperature(), t_w[i]);
+    EXPECT_EQ(model.getMotorHousingTemperature(), t_h[i]);
+    EXPECT_EQ(model.getActuatorBodyTemperature(), t_b[i]);
+  }
+}
+
+// A step of zero length changes nothing
+TEST_P(TemperatureModelTests, ZeroStepKeepsTemperatures) {
+  TemperatureModel model = createModel();
+  Temperatures before = temperatures(model);
+  model.update(500.0, 0.0);
+  expectTemperaturesNear(before, temperatures(model), 1e-12);
+}
+
+// Steps far longer than the winding's time constant, where explicit Euler
+// would diverge, settle at the steady state of the thermal resistances
+TEST_P(TemperatureModelTests, LongStepReachesSteadyState) {
+  TemperatureModel model = createModel();
+  const TemperatureModel::Parameters& params = model.getParameters();
+  const double power_in = 10.0;
+  for (int i = 0; i < 100; ++i)
+    model.update(power_in, 10000.0);
+
+  const double t_e = TemperatureModel::t_e_;
+  Temperatures steady = {
+    t_e + power_in * (params.r_wh + params.r_hb + params.r_be),
+    t_e + power_in * (params.r_hb + params.r_be),
+    t_e + power_in * params.r_be};
+  expectTemperaturesNear(steady, temperatures(model), 1e-6);
+}
+
+INSTANTIATE_TEST_CASE_P(Actuators, TemperatureModelTests, ::testing::Values(false, true));
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <thread>
+
+#include "sim/hebiros_triple_buffer.h"
+
+using hebiros::sim::TripleBuffer;
+
+TEST(TripleBufferTests, NothingToAcquireBeforePublish) {
+  TripleBuffer<int> buffer;
+  EXPECT_FALSE(buffer.acquire());
+}
+
+// Each publish can be acquired once; acquiring again without a new publish
+// keeps the front buffer
+TEST(TripleBufferTests, AcquireTakesEachPublishOnce) {
+  TripleBuffer<int> buffer;
+  for (int value = 1; value <= 10; ++value) {
+    buffer.back() = value;
+    buffer.publish();
+    ASSERT_TRUE(buffer.acquire());
+    EXPECT_EQ(value, buffer.front());
+    EXPECT_FALSE(buffer.acquire());
+    EXPECT_EQ(value, buffer.front());
+  }
+}
+
+// Publishing several times between acquires hands over only the latest value
+TEST(TripleBufferTests, AcquireReturnsLatestPublish) {
+  TripleBuffer<int> buffer;
+  int value = 0;
+  for (int published = 1; published <= 5; ++published) {
+    for (int i = 0; i < published; ++i) {
+      buffer.back() = ++value;
+      buffer.publish();
+    }
+    ASSERT_TRUE(buffer.acquire());
+    EXPECT_EQ(value, buffer.front());
+    EXPECT_FALSE(buffer.acquire());
+  }
+}
+
+// The writer's back buffer is never the reader's front buffer
+TEST(TripleBufferTests, WritingDoesNotChangeFront) {
+  TripleBuffer<int> buffer;
+  buffer.back() = 1;
+  buffer.publish();
+  ASSERT_TRUE(buffer.acquire());
+  for (int value = 2; value < 10; ++value) {
+    buffer.back() = value;
+    EXPECT_EQ(1, buffer.front());
+    buffer.publish();
+    EXPECT_EQ(1, buffer.front());
+  }
+}
+
+// A reader on another thread only sees whole values, never goes back to an
+// older one, and ends up with the last one published
+TEST(TripleBufferTests, ReaderSeesCompleteIncreasingValues) {
+  typedef std::array<uint64_t, 16> Value;
+  static constexpr uint64_t count = 200000;
+  TripleBuffer<Value> buffer;
+  for (size_t i = 0; i < 3; ++i)
+    buffer[i].fill(0);
+
+  std::thread writer([&buffer]() {
+    for (uint64_t value = 1; value <= count; ++value) {
+      buffer.back().fill(value);
+      buffer.publish();
+    }
+  });
+
+  // Check after joining the writer, so a failure does not leave it running
+  uint64_t last = 0;
+  bool complete = true;
+  bool increasing = true;
+  while (last < count && complete && increasing) {
+    if (!buffer.acquire())
+      continue;
+    const Value& value = buffer.front();
+    for (uint64_t element : value)
+      complete = complete && element == value[0];
+    increasing = value[0] > last;
+    last = value[0];
+  }
+  writer.join();
+  EXPECT_TRUE(complete) << "torn value " << last;
+  EXPECT_TRUE(increasing) << "went back to " << last;
+  EXPECT_EQ(count, last);
+  EXPECT_FALSE(buffer.acquire());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
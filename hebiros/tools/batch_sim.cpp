@@ -0,0 +1,261 @@
+// Runs many independent simulations of one arm, without Gazebo or a ROS
+// master, to compare gains and trajectory timings against the actuator model
+// of the simulators (see HebirosGroupSim and hebiros::sim::ActuatorController).
+//
+// Usage: hebiros_batch_sim <urdf file> <scenario file> <output file> [time step (s)] [hold time (s)]
+//
+// Each line of the scenario file is one run:
+//
+//   <control strategy> <position kp ki kd> <velocity kp ki kd> <effort kp ki kd>
+//     <move time (s)> <target position of each joint, in URDF order>
+//
+// Blank lines and lines starting with '#' are skipped. Every joint starts at
+// zero with the given control strategy and gains, follows a trajectory to the
+// targets over the move time, and then holds them for the hold time. Runs are
+// spread over all cores, and the output has one column per result and one
+// row per run, in scenario order:
+//
+//   run  rms_error  max_error  final_error  peak_winding_temperature  safety_limit_count
+//
+// Errors are the distance (rad or m) between the trajectory and the joint
+// positions, over all joints and steps; the safety limit count is the number
+// of joint updates in which the temperature safety limit reduced the PWM.
+
+#include "hebiros_group_sim.h"
+#include "hebiros_model.h"
+
+#include "trajectory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+struct Scenario {
+  int control_strategy;
+  double gains[9];
+  double move_time;
+  Eigen::VectorXd targets;
+};
+
+struct Result {
+  double rms_error;
+  double max_error;
+  double final_error;
+  double peak_winding_temperature;
+  uint64_t safety_limit_count;
+};
+
+static bool readScenarios(const std::string& file, size_t dof_count,
+  std::vector<Scenario>& scenarios) {
+
+  std::ifstream input(file);
+  if (!input) {
+    std::cerr << "Could not open " << file << std::endl;
+    return false;
+  }
+
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(input, line)) {
+    ++line_number;
+    std::istringstream columns(line);
+    std::string first;
+    if (!(columns >> first) || first[0] == '#')
+      continue;
+    columns.clear();
+    columns.str(line);
+
+    Scenario scenario;
+    scenario.targets.resize(dof_count);
+    bool valid = static_cast<bool>(columns >> scenario.control_strategy);
+    for (double& gain : scenario.gains)
+      valid = valid && (columns >> gain);
+    valid = valid && (columns >> scenario.move_time);
+    for (size_t i = 0; i < dof_count; ++i)
+      valid = valid && (columns >> scenario.targets[i]);
+    std::string extra;
+    if (!valid || (columns >> extra) || scenario.move_time <= 0) {
+      std::cerr << file << ":" << line_number << ": expected a control strategy, 9 gains, " <<
+        "a positive move time and " << dof_count << " targets" << std::endl;
+      return false;
+    }
+    scenarios.push_back(scenario);
+  }
+  return true;
+}
+
+// Sets up a simulated group with the model's joints; URDF joints named
+// "family/name/<module type>" get the actuator model of that module type.
+static void addJoints(const HebirosModel& model, HebirosGroupSim& group) {
+  const std::vector<std::string>& joint_names = model.getJointNames();
+  for (size_t i = 0; i < joint_names.size(); ++i) {
+    size_t separator = joint_names[i].rfind('/');
+    std::string name = separator == std::string::npos ?
+      joint_names[i] : joint_names[i].substr(0, separator);
+    group.joints[name] = i;
+    group.joint_full_names[name] = joint_names[i];
+  }
+  group.size = joint_names.size();
+  group.initialize();
+  group.setCommandLifetime(0);
+}
+
+static Result run(const HebirosModel& model, const Scenario& scenario, double dt,
+  double hold_time) {
+
+  HebirosGroupSim group;
+  addJoints(model, group);
+  group.model.reset(new HebirosGroupModel(model, group));
+
+  size_t dof_count = model.getDoFCount();
+  Eigen::VectorXd times(2);
+  times << 0, scenario.move_time;
+  Eigen::MatrixXd positions(dof_count, 2);
+  positions.col(0).setZero();
+  positions.col(1) = scenario.targets;
+  Eigen::MatrixXd rest = Eigen::MatrixXd::Zero(dof_count, 2);
+  auto trajectory = hebi::trajectory::Trajectory::createUnconstrainedQp(
+    times, positions, &rest, &rest);
+
+  // Group joints are in URDF order (see addJoints)
+  hebiros::CommandMsg command_msg;
+  command_msg.name.resize(dof_count);
+  for (auto& joint : group.joints)
+    command_msg.name[joint.second] = joint.first;
+  command_msg.position.resize(dof_count);
+  command_msg.velocity.resize(dof_count);
+
+  hebiros::SettingsMsg& settings = command_msg.settings;
+  settings.control_strategy.assign(dof_count, scenario.control_strategy);
+  const double* gains = scenario.gains;
+  settings.position_gains.kp.assign(dof_count, gains[0]);
+  settings.position_gains.ki.assign(dof_count, gains[1]);
+  settings.position_gains.kd.assign(dof_count, gains[2]);
+  settings.velocity_gains.kp.assign(dof_count, gains[3]);
+  settings.velocity_gains.ki.assign(dof_count, gains[4]);
+  settings.velocity_gains.kd.assign(dof_count, gains[5]);
+  settings.effort_gains.kp.assign(dof_count, gains[6]);
+  settings.effort_gains.ki.assign(dof_count, gains[7]);
+  settings.effort_gains.kd.assign(dof_count, gains[8]);
+
+  Result result = {};
+  Eigen::VectorXd position(dof_count), velocity(dof_count), acceleration(dof_count);
+  double squared_error = 0;
+  size_t steps = static_cast<size_t>(std::ceil((scenario.move_time + hold_time) / dt));
+  ros::Time time;
+
+  for (size_t step = 0; step < steps; ++step) {
+    double t = std::min(step * dt, scenario.move_time);
+    trajectory->getState(t, &position, &velocity, &acceleration);
+    for (size_t i = 0; i < dof_count; ++i) {
+      command_msg.position[i] = position[i];
+      command_msg.velocity[i] = step * dt < scenario.move_time ? velocity[i] : 0;
+    }
+    group.setCommand(command_msg, time);
+
+    // Settings only go with the first command
+    if (step == 0)
+      settings = hebiros::SettingsMsg();
+
+    time += ros::Duration(dt);
+    group.step(dt, time);
+
+    // Feedback has the positions and temperatures from before the step
+    const hebiros::FeedbackMsg& feedback = group.getFeedback();
+    for (size_t i = 0; i < dof_count; ++i) {
+      double error = std::abs(feedback.position[i] - position[i]);
+      squared_error += error * error;
+      result.max_error = std::max(result.max_error, error);
+      result.peak_winding_temperature = std::max(result.peak_winding_temperature,
+        feedback.motor_winding_temperature[i]);
+    }
+  }
+
+  const hebiros::FeedbackMsg& feedback = group.getFeedback();
+  for (size_t i = 0; i < dof_count; ++i) {
+    result.final_error = std::max(result.final_error,
+      std::abs(feedback.position[i] - scenario.targets[i]));
+  }
+  result.rms_error = steps > 0 ? std::sqrt(squared_error / (steps * dof_count)) : 0;
+  for (uint64_t count : group.getController().safety_limit_count)
+    result.safety_limit_count += count;
+  return result;
+}
+
+int main(int argc, char** argv) {
+
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0] <<
+      " <urdf file> <scenario file> <output file> [time step (s)] [hold time (s)]" << std::endl;
+    return 1;
+  }
+  std::string urdf_file = argv[1];
+  std::string scenario_file = argv[2];
+  std::string output_file = argv[3];
+  double dt = argc > 4 ? std::stod(argv[4]) : 0.001;
+  double hold_time = argc > 5 ? std::stod(argv[5]) : 1.0;
+  if (dt <= 0 || hold_time < 0) {
+    std::cerr << "The time step must be positive, and the hold time not negative" << std::endl;
+    return 1;
+  }
+
+  urdf::Model urdf;
+  if (!urdf.initFile(urdf_file)) {
+    std::cerr << "Could not parse " << urdf_file << std::endl;
+    return 1;
+  }
+
+  std::unique_ptr<HebirosModel> model = HebirosModel::fromURDF(urdf);
+  if (!model) {
+    std::cerr << "Could not create a model from " << urdf_file << std::endl;
+    return 1;
+  }
+  if (!model->isChain()) {
+    std::cerr << "Only models without branches are simulated" << std::endl;
+    return 1;
+  }
+
+  std::vector<Scenario> scenarios;
+  if (!readScenarios(scenario_file, model->getDoFCount(), scenarios))
+    return 1;
+
+  std::cout << "Simulating " << scenarios.size() << " runs of " << model->getDoFCount() <<
+    " joints with a " << dt << " s step" << std::endl;
+
+  // Each thread uses its own robot model and takes the next run until there
+  // are none left; runs only share the results.
+  std::vector<Result> results(scenarios.size());
+  std::atomic<size_t> next_run(0);
+  unsigned int thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&]() {
+      std::unique_ptr<HebirosModel> thread_model = HebirosModel::fromURDF(urdf);
+      for (size_t i = next_run++; i < scenarios.size(); i = next_run++)
+        results[i] = run(*thread_model, scenarios[i], dt, hold_time);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  std::ofstream output(output_file);
+  output << "run\trms_error\tmax_error\tfinal_error\tpeak_winding_temperature\t" <<
+    "safety_limit_count\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+    output << i << '\t' << result.rms_error << '\t' << result.max_error << '\t' <<
+      result.final_error << '\t' << result.peak_winding_temperature << '\t' <<
+      result.safety_limit_count << '\n';
+  }
+  if (!output) {
+    std::cerr << "Could not write " << output_file << std::endl;
+    return 1;
+  }
+
+  std::cout << "Wrote " << output_file << std::endl;
+  return 0;
+}
@@ -0,0 +1,206 @@
+// Generates the reachability map of a model for the node to load (see
+// "hebiros/reachability_map_dir"; the node looks for <model name>.hebimap).
+//
+// Usage: hebiros_reachability_map <urdf file> <output file> [samples] [voxel size (m)]
+//
+// Joint configurations are sampled uniformly within the URDF joint limits
+// (continuous joints, and revolute joints without limits, use -pi to pi) on all
+// cores, and the end effector position and manipulability of each sample are
+// binned into a voxel grid around the model's base.
+
+#include "hebiros_model.h"
+#include "hebiros_reachability_map.h"
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+
+static bool getJointLimits(const urdf::Model& urdf, const HebirosModel& model,
+  Eigen::VectorXd& lower, Eigen::VectorXd& upper) {
+
+  const std::vector<std::string>& joint_names = model.getJointNames();
+  lower.resize(joint_names.size());
+  upper.resize(joint_names.size());
+  for (size_t i = 0; i < joint_names.size(); ++i) {
+    auto joint = urdf.getJoint(joint_names[i]);
+    if (!joint)
+      return false;
+    bool has_limits = joint->type != urdf::Joint::CONTINUOUS && joint->limits &&
+      joint->limits->lower < joint->limits->upper;
+    if (has_limits) {
+      lower[i] = joint->limits->lower;
+      upper[i] = joint->limits->upper;
+    } else if (joint->type == urdf::Joint::PRISMATIC) {
+      std::cerr << "Prismatic joint " << joint_names[i] << " has no limits" << std::endl;
+      return false;
+    } else {
+      lower[i] = -M_PI;
+      upper[i] = M_PI;
+    }
+  }
+  return true;
+}
+
+// Upper bound on the distance of the end effector from the base frame: the sum
+// of the lengths of all fixed transforms, plus the travel of prismatic joints.
+static double getReach(const HebirosModel& model, const Eigen::VectorXd& lower,
+  const Eigen::VectorXd& upper) {
+
+  double reach = 0;
+  size_t joint = 0;
+  for (auto& element : model.getChains()[0].elements) {
+    if (element.type == HebirosModel::Element::Type::RigidBody) {
+      reach += Eigen::Vector3d(element.output[3], element.output[7], element.output[11]).norm();
+    } else {
+      if (element.joint_type == HebiJointTypeTranslationX ||
+        element.joint_type == HebiJointTypeTranslationY ||
+        element.joint_type == HebiJointTypeTranslationZ) {
+        reach += std::max(std::abs(lower[joint]), std::abs(upper[joint]));
+      }
+      ++joint;
+    }
+  }
+  return reach;
+}
+
+// sqrt(det(J * J^T)), using only the position rows for fewer than 6 joints
+static double getManipulability(const Eigen::MatrixXd& jacobian) {
+  double det;
+  if (jacobian.cols() >= 6)
+    det = (jacobian * jacobian.transpose()).determinant();
+  else
+    det = (jacobian.topRows<3>() * jacobian.topRows<3>().transpose()).determinant();
+  return std::sqrt(std::max(det, 0.0));
+}
+
+int main(int argc, char** argv) {
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] <<
+      " <urdf file> <output file> [samples] [voxel size (m)]" << std::endl;
+    return 1;
+  }
+  std::string urdf_file = argv[1];
+  std::string output_file = argv[2];
+  uint64_t samples = argc > 3 ? std::stoull(argv[3]) : 1000000;
+  double voxel_size = argc > 4 ? std::stod(argv[4]) : 0.05;
+  if (samples == 0 || voxel_size <= 0) {
+    std::cerr << "Samples and voxel size must be positive" << std::endl;
+    return 1;
+  }
+
+  urdf::Model urdf;
+  if (!urdf.initFile(urdf_file)) {
+    std::cerr << "Could not parse " << urdf_file << std::endl;
+    return 1;
+  }
+
+  std::unique_ptr<HebirosModel> model = HebirosModel::fromURDF(urdf);
+  if (!model) {
+    std::cerr << "Could not create a model from " << urdf_file << std::endl;
+    return 1;
+  }
+  if (!model->isChain()) {
+    std::cerr << "Reachability maps are only supported for models without branches" << std::endl;
+    return 1;
+  }
+
+  size_t dof_count = model->getDoFCount();
+  Eigen::VectorXd lower, upper;
+  if (!getJointLimits(urdf, *model, lower, upper))
+    return 1;
+
+  // Grid centered on the base frame, large enough for any reachable position
+  Eigen::Vector3d center = model->getModel().getBaseFrame().topRightCorner<3,1>();
+  double reach = getReach(*model, lower, upper);
+  uint32_t size = static_cast<uint32_t>(std::ceil(2 * reach / voxel_size)) + 1;
+  size_t voxel_count = static_cast<size_t>(size) * size * size;
+
+  HebirosReachabilityMap::Header header = {};
+  header.dof_count = dof_count;
+  header.voxel_size = voxel_size;
+  header.sample_count = samples;
+  for (size_t i = 0; i < 3; ++i) {
+    header.origin[i] = center[i] - size * voxel_size / 2;
+    header.size[i] = size;
+  }
+
+  std::unique_ptr<std::atomic<uint32_t>[]> counts(new std::atomic<uint32_t>[voxel_count]);
+  std::unique_ptr<std::atomic<float>[]> manipulabilities(new std::atomic<float>[voxel_count]);
+  for (size_t i = 0; i < voxel_count; ++i) {
+    counts[i].store(0, std::memory_order_relaxed);
+    manipulabilities[i].store(0, std::memory_order_relaxed);
+  }
+
+  std::cout << "Sampling " << samples << " configurations of " << dof_count <<
+    " joints into " << size << "^3 voxels of " << voxel_size << " m" << std::endl;
+
+  // Each thread uses its own robot model and buffers, so nothing but the grid
+  // is shared.
+  unsigned int thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < thread_count; ++t) {
+    uint64_t thread_samples = samples / thread_count + (t < samples % thread_count ? 1 : 0);
+    threads.emplace_back([&, t, thread_samples]() {
+      std::unique_ptr<HebirosModel> thread_model = HebirosModel::fromURDF(urdf);
+      const hebi::robot_model::RobotModel& robot = thread_model->getModel();
+      std::mt19937_64 rng(t);
+      std::uniform_real_distribution<double> uniform(0.0, 1.0);
+      Eigen::VectorXd positions(dof_count);
+      Eigen::Matrix4d end_effector;
+      Eigen::MatrixXd jacobian(6, dof_count);
+
+      for (uint64_t s = 0; s < thread_samples; ++s) {
+        for (size_t j = 0; j < dof_count; ++j)
+          positions[j] = lower[j] + (upper[j] - lower[j]) * uniform(rng);
+        robot.getEndEffector(positions, end_effector);
+        robot.getJEndEffector(positions, jacobian);
+
+        size_t index = 0;
+        size_t stride = 1;
+        bool inside = true;
+        for (size_t i = 0; i < 3; ++i) {
+          double cell = std::floor((end_effector(i, 3) - header.origin[i]) / voxel_size);
+          if (cell < 0 || cell >= size) {
+            inside = false;
+            break;
+          }
+          index += static_cast<size_t>(cell) * stride;
+          stride *= size;
+        }
+        if (!inside)
+          continue;
+
+        counts[index].fetch_add(1, std::memory_order_relaxed);
+        float manipulability = getManipulability(jacobian);
+        float current = manipulabilities[index].load(std::memory_order_relaxed);
+        while (manipulability > current &&
+          !manipulabilities[index].compare_exchange_weak(current, manipulability,
+          std::memory_order_relaxed)) {
+        }
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  std::vector<HebirosReachabilityMap::Voxel> voxels(voxel_count);
+  size_t reached = 0;
+  for (size_t i = 0; i < voxel_count; ++i) {
+    voxels[i].count = counts[i].load();
+    voxels[i].manipulability = manipulabilities[i].load();
+    if (voxels[i].count > 0)
+      ++reached;
+  }
+
+  if (!HebirosReachabilityMap::write(output_file, header, voxels)) {
+    std::cerr << "Could not write " << output_file << std::endl;
+    return 1;
+  }
+  std::cout << "Wrote " << output_file << "; " << reached << " of " << voxel_count <<
+    " voxels reached" << std::endl;
+
+  return 0;
+}
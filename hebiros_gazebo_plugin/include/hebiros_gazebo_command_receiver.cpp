@@ -0,0 +1,35 @@
+#include <hebiros_gazebo_command_receiver.h>
+
+constexpr std::chrono::microseconds HebirosGazeboCommandReceiver::POLL_PERIOD;
+
+HebirosGazeboCommandReceiver::~HebirosGazeboCommandReceiver() {
+  this->running = false;
+  if (this->thread.joinable()) {
+    this->thread.join();
+  }
+}
+
+//Start taking the commands of a group with a command ring
+void HebirosGazeboCommandReceiver::AddGroup(std::shared_ptr<HebirosGazeboGroup> hebiros_group) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->hebiros_groups.push_back(hebiros_group);
+  if (!this->thread.joinable()) {
+    this->thread = std::thread(&HebirosGazeboCommandReceiver::Run, this);
+  }
+}
+
+//Poll the command rings until the plugin is unloaded
+void HebirosGazeboCommandReceiver::Run() {
+  while (this->running) {
+    bool received = false;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      for (auto& hebiros_group : this->hebiros_groups) {
+        received |= hebiros_group->ReceiveRingCommands();
+      }
+    }
+    if (!received) {
+      std::this_thread::sleep_for(POLL_PERIOD);
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hebiros_gazebo_group.h"
+
+// Takes the commands that nodes write to the command rings of their groups on
+// its own thread, so that deserializing commands and gathering them into the
+// controllers is not part of the physics step. The node does not signal its
+// writes, so the rings are polled; the thread starts with the first group
+// that has a ring.
+class HebirosGazeboCommandReceiver {
+
+public:
+
+  HebirosGazeboCommandReceiver() = default;
+  ~HebirosGazeboCommandReceiver();
+
+  void AddGroup(std::shared_ptr<HebirosGazeboGroup> hebiros_group);
+
+private:
+
+  // How long the thread sleeps after finding all rings empty
+  static constexpr std::chrono::microseconds POLL_PERIOD {20};
+
+  std::vector<std::shared_ptr<HebirosGazeboGroup>> hebiros_groups;
+  std::mutex mutex;
+  std::atomic<bool> running {true};
+  std::thread thread;
+
+  void Run();
+
+};
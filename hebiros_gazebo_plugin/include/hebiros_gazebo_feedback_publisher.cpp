@@ -0,0 +1,45 @@
+#include <hebiros_gazebo_feedback_publisher.h>
+
+constexpr std::chrono::milliseconds HebirosGazeboFeedbackPublisher::WAKE_PERIOD;
+
+HebirosGazeboFeedbackPublisher::HebirosGazeboFeedbackPublisher()
+  : thread(&HebirosGazeboFeedbackPublisher::Run, this) {
+}
+
+HebirosGazeboFeedbackPublisher::~HebirosGazeboFeedbackPublisher() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->running = false;
+  }
+  this->condition.notify_one();
+  this->thread.join();
+}
+
+//Start publishing the feedback snapshots of a group
+void HebirosGazeboFeedbackPublisher::AddGroup(std::shared_ptr<HebirosGazeboGroup> hebiros_group) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->hebiros_groups.push_back(hebiros_group);
+}
+
+void HebirosGazeboFeedbackPublisher::Notify() {
+  this->pending.store(true, std::memory_order_release);
+  this->condition.notify_one();
+}
+
+//Publish new feedback snapshots until the plugin is unloaded
+void HebirosGazeboFeedbackPublisher::Run() {
+  std::unique_lock<std::mutex> lock(this->mutex);
+
+  while (this->running) {
+    this->condition.wait_for(lock, WAKE_PERIOD, [this] {
+      return this->pending.load(std::memory_order_acquire) || !this->running;
+    });
+    this->pending.store(false, std::memory_order_relaxed);
+
+    for (auto& hebiros_group : this->hebiros_groups) {
+      if (hebiros_group->feedback_buffer.acquire()) {
+        hebiros_group->PublishFeedback(hebiros_group->feedback_buffer.front());
+      }
+    }
+  }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "hebiros_gazebo_group.h"
+
+// Publishes group feedback from its own thread, so that message serialization
+// is not part of the physics step. The physics thread hands over a snapshot of
+// a group's feedback when it is due (see HebirosGazeboGroup::feedback_buffer)
+// and calls Notify; this thread publishes every new snapshot.
+class HebirosGazeboFeedbackPublisher {
+
+public:
+
+  HebirosGazeboFeedbackPublisher();
+  ~HebirosGazeboFeedbackPublisher();
+
+  void AddGroup(std::shared_ptr<HebirosGazeboGroup> hebiros_group);
+
+  //Wake the publishing thread; called from the physics thread, never blocks
+  void Notify();
+
+private:
+
+  // Upper bound on the delay of a snapshot whose notification was missed
+  // because it arrived just before the thread started waiting
+  static constexpr std::chrono::milliseconds WAKE_PERIOD {10};
+
+  std::vector<std::shared_ptr<HebirosGazeboGroup>> hebiros_groups;
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::atomic<bool> pending {false};
+  bool running = true;
+  std::thread thread;
+
+  void Run();
+
+};
@@ -1,6 +1,11 @@
 #include <hebiros_gazebo_group.h>
 #include "hebiros_gazebo_controller.h"
 
+// Shared memory rings hold this many messages of up to SHM_SLOT_SIZE bytes;
+// larger messages go through the topics
+static constexpr uint32_t SHM_SLOT_COUNT = 16;
+static constexpr uint32_t SHM_SLOT_SIZE = 32768;
+
 HebirosGazeboGroup::HebirosGazeboGroup(std::string name,
   std::shared_ptr<ros::NodeHandle> n) {
   this->name = name;
@@ -29,34 +34,151 @@ HebirosGazeboGroup::HebirosGazeboGroup(std::string name,
     &HebirosGazeboGroup::SrvSetFeedbackFrequency, this, _1, _2));
 }
 
+//Create the rings that replace the command and feedback topics when the node
+//runs on the same host; both sides name them after the resolved topics
+void HebirosGazeboGroup::OpenSharedMemory(std::shared_ptr<ros::NodeHandle> n) {
+
+  this->command_ring = hebiros::sim::ShmRing::create(
+    hebiros::sim::ShmRing::nameForTopic(n->resolveName("hebiros_gazebo_plugin/command/"+name)),
+    SHM_SLOT_COUNT, SHM_SLOT_SIZE);
+  this->feedback_ring = hebiros::sim::ShmRing::create(
+    hebiros::sim::ShmRing::nameForTopic(n->resolveName("hebiros_gazebo_plugin/feedback/"+name)),
+    SHM_SLOT_COUNT, SHM_SLOT_SIZE);
+
+  if (!this->command_ring || !this->feedback_ring) {
+    ROS_WARN("Could not create shared memory for group %s; using topics", name.c_str());
+    this->command_ring.reset();
+    this->feedback_ring.reset();
+    return;
+  }
+  this->command_ring->attachReader(true);
+}
+
 void HebirosGazeboGroup::SubCommand(const boost::shared_ptr<CommandMsg const> data) {
 
+  std::lock_guard<std::mutex> receive_lock(this->receive_mutex);
+
+  //The node publishes a command only after writing any earlier ones to the
+  //ring, so apply those first
+  ReadRingCommands();
+  this->command_target = *data;
+  ReceiveCommand();
+}
+
+//Take the commands the node wrote to the command ring; called only by the
+//thread receiving commands. Returns whether there was any.
+bool HebirosGazeboGroup::ReceiveRingCommands() {
+  if (!this->command_ring) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> receive_lock(this->receive_mutex);
+  return ReadRingCommands();
+}
+
+//Apply the commands in the command ring, deserializing each straight into
+//command_target; requires receive_mutex
+bool HebirosGazeboGroup::ReadRingCommands() {
+  if (!this->command_ring) {
+    return false;
+  }
+
+  bool received = false;
+  while (this->command_ring->read(this->command_target)) {
+    ReceiveCommand();
+    received = true;
+  }
+  return received;
+}
+
+//Write feedback to the node through the feedback ring while the node reads
+//it, or publish it otherwise. Once the ring is full or a message does not fit,
+//keep publishing, so that no feedback overtakes feedback still in the ring.
+void HebirosGazeboGroup::PublishFeedback(const FeedbackMsg& feedback) {
+  if (this->feedback_ring && !this->feedback_fallback && this->feedback_ring->hasReader()) {
+    if (this->feedback_ring->write(feedback)) {
+      return;
+    }
+    ROS_WARN("Could not write feedback of group %s to shared memory; publishing it from now on",
+      this->name.c_str());
+    this->feedback_fallback = true;
+  }
+  this->feedback_pub.publish(feedback);
+}
+
+//Apply the command just stored in command_target; requires receive_mutex
+void HebirosGazeboGroup::ReceiveCommand() {
+
   if (this->check_acknowledgement) {
     this->acknowledgement = true;
     this->check_acknowledgement = false;
   }
 
-  if (!this->command_received) {
-    this->command_received = true;
-  }
-
+  // The physics thread restarts the command lifetime and iteration timing
+  // from this time once it picks the command up
   ros::Time current_time = ros::Time::now();
-  this->start_time = current_time;
-  this->prev_time = current_time;
 
-  command_target = *data;
+  // Nodes send the same names in every command, so the joints are only
+  // looked up again when they change
+  if (this->command_target.name != this->command_names) {
+    this->command_names = this->command_target.name;
+    this->command_joints.clear();
+
+    for (int i = 0; i < this->command_names.size(); i++) {
+      auto joint_it = joints.find(this->command_names[i]);
+
+      if (joint_it != joints.end()) {
+        const std::shared_ptr<HebirosGazeboJoint>& hebiros_joint = joint_it->second;
+        hebiros_joint->command_index = i;
+        if (hebiros_joint->feedback_index < this->command_indices.size()) {
+          this->command_indices[hebiros_joint->feedback_index] = i;
+        }
+        this->command_joints.push_back(hebiros_joint);
+      }
+    }
+  }
 
-  for (int i = 0; i < data->name.size(); i++) {
-    std::string joint_name = data->name[i];
+  for (auto& hebiros_joint : this->command_joints) {
+    HebirosGazeboController::ChangeSettings(shared_from_this(), hebiros_joint);
+  }
 
-    if (joints.find(joint_name) != joints.end()) {
-      std::shared_ptr<HebirosGazeboJoint> hebiros_joint = joints[joint_name];
-      hebiros_joint->command_index = i;
+  UpdateController(current_time);
 
-      HebirosGazeboController::ChangeSettings(shared_from_this(),
-        hebiros_joint);
-    }
+  {
+    std::lock_guard<std::mutex> lock(this->command_mutex);
+    this->received_command_count++;
   }
+  this->command_condition.notify_one();
+}
+
+//Gather the current command and settings into the controller, following the
+//command index of each joint. Only the gathered arrays are handed to the
+//physics thread; command_target and settings stay with the threads receiving
+//commands.
+void HebirosGazeboGroup::UpdateController(const ros::Time& time) {
+
+  this->controller.setCommand(this->command_target, this->settings,
+    this->command_indices, time);
+}
+
+//Mark that a reply to the feedback just published is expected; commands
+//received before this do not count as the reply. Only lockstep mode calls
+//this and WaitForCommand, so the physics thread never takes the lock
+//otherwise.
+void HebirosGazeboGroup::ExpectCommand() {
+
+  std::lock_guard<std::mutex> lock(this->command_mutex);
+  this->expected_after_count = this->received_command_count;
+}
+
+//Wait for a command received after the last ExpectCommand; returns false on
+//timeout
+bool HebirosGazeboGroup::WaitForCommand(const std::chrono::duration<double>& timeout) {
+
+  std::unique_lock<std::mutex> lock(this->command_mutex);
+  return this->command_condition.wait_for(lock, timeout, [this] {
+    return this->received_command_count > this->expected_after_count;
+  });
 }
 
 //Service callback which acknowledges that a command has been received
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
 #include "ros/ros.h"
 #include "std_srvs/Empty.h"
 #include "hebiros/FeedbackMsg.h"
@@ -8,6 +14,9 @@
 #include "hebiros/SetCommandLifetimeSrv.h"
 #include "hebiros/SetFeedbackFrequencySrv.h"
 #include "hebiros_gazebo_joint.h"
+#include "hebiros/sim/hebiros_actuator_controller.h"
+#include "hebiros/sim/hebiros_shm_ring.h"
+#include "hebiros/sim/hebiros_triple_buffer.h"
 
 using namespace hebiros;
 
@@ -19,12 +28,17 @@ public:
   std::string name;
   std::map<std::string, std::shared_ptr<HebirosGazeboJoint>> joints;
   FeedbackMsg feedback;
+  // Feedback snapshots, from the physics thread to the publishing thread
+  hebiros::sim::TripleBuffer<FeedbackMsg> feedback_buffer;
   CommandMsg command_target;
+  // Index in command_target of each joint, by feedback index; built as
+  // joints are added, and updated only when the commanded names change
+  std::vector<int> command_indices;
   SettingsMsg settings;
+  hebiros::sim::ActuatorController controller;
   bool check_acknowledgement = false;
   bool acknowledgement = false;
-  bool command_received = false;
-  bool group_added = false;
+  std::atomic<bool> group_added {false};
   int command_lifetime = 100;
   int feedback_frequency = 100;
 
@@ -32,15 +46,62 @@ public:
   ros::Time prev_time;
   ros::Time prev_feedback_time;
 
+  // Lockstep state, used only by the thread stepping the group: steps since
+  // the group was added, and whether the step after the last feedback has to
+  // wait for the node's reply
+  uint64_t step_count = 0;
+  bool awaiting_command = false;
+
+  // Whether the forces computed by the last step are applied; set by the
+  // step, read by the physics thread once all groups have stepped
+  bool command_active = false;
+
+  // Shared memory rings to and from a node on the same host, used instead of
+  // the command and feedback topics once the node attaches to them; null if
+  // shared memory is off or could not be set up
+  std::unique_ptr<hebiros::sim::ShmRing> command_ring;
+  std::unique_ptr<hebiros::sim::ShmRing> feedback_ring;
+  // Set once feedback has been published while the node reads the ring; only
+  // used by the thread publishing feedback
+  bool feedback_fallback = false;
+
   ros::Subscriber command_sub;
   ros::Publisher feedback_pub;
   ros::ServiceServer acknowledge_srv;
   ros::ServiceServer command_lifetime_srv;
   ros::ServiceServer feedback_frequency_srv;
 
+private:
+
+  // Commands received in total, and as of the last ExpectCommand; in
+  // lockstep mode the physics thread waits on these for the reply to each
+  // feedback
+  std::mutex command_mutex;
+  std::condition_variable command_condition;
+  uint64_t received_command_count = 0;
+  uint64_t expected_after_count = 0;
+
+  // Commands arrive from the ROS callback thread and, through the command
+  // ring, from the thread receiving commands; this keeps them in order
+  std::mutex receive_mutex;
+  // Joints named by the last command, whose indices are in command_indices
+  std::vector<std::string> command_names;
+  std::vector<std::shared_ptr<HebirosGazeboJoint>> command_joints;
+
+  void ReceiveCommand();
+  bool ReadRingCommands();
+
+public:
+
   HebirosGazeboGroup(std::string name, std::shared_ptr<ros::NodeHandle> n);
 
+  void OpenSharedMemory(std::shared_ptr<ros::NodeHandle> n);
   void SubCommand(const boost::shared_ptr<CommandMsg const> data);
+  bool ReceiveRingCommands();
+  void PublishFeedback(const FeedbackMsg& feedback);
+  void UpdateController(const ros::Time& time);
+  void ExpectCommand();
+  bool WaitForCommand(const std::chrono::duration<double>& timeout);
   bool SrvAcknowledge(std_srvs::Empty::Request &req, std_srvs::Empty::Response &res);
   bool SrvSetCommandLifetime(SetCommandLifetimeSrv::Request &req, SetCommandLifetimeSrv::Response &res);
   bool SrvSetFeedbackFrequency(SetFeedbackFrequencySrv::Request &req, SetFeedbackFrequencySrv::Response &res);
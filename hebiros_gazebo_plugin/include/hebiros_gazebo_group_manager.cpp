@@ -0,0 +1,376 @@
+#include <hebiros_gazebo_group_manager.h>
+
+#include "hebiros/sim/hebiros_actuator_settings.h"
+
+constexpr int HebirosGazeboGroupManager::STEP_TIME_ITERATIONS;
+
+//Read the plugin options and start serving groups
+void HebirosGazeboGroupManager::Load(std::shared_ptr<ros::NodeHandle> n,
+  sdf::ElementPtr _sdf, ModelLookup find_model) {
+
+  this->n = n;
+  this->find_model = find_model;
+
+  //Lockstep mode: time comes from the simulation, feedback is published
+  //every feedback_decimation steps, and the step after each feedback waits
+  //for the node's command
+  this->lockstep = false;
+  if (_sdf->HasElement("lockstep")) {
+    this->lockstep = _sdf->GetElement("lockstep")->Get<bool>();
+  }
+  else {
+    this->n->param<bool>("hebiros/lockstep", this->lockstep, false);
+  }
+  if (_sdf->HasElement("feedbackDecimation")) {
+    this->feedback_decimation = std::max(
+      _sdf->GetElement("feedbackDecimation")->Get<int>(), 1);
+  }
+  if (_sdf->HasElement("lockstepTimeout")) {
+    this->lockstep_timeout = _sdf->GetElement("lockstepTimeout")->Get<double>();
+  }
+  if (this->lockstep) {
+    ROS_INFO("Lockstep mode: feedback every %d steps", this->feedback_decimation);
+  }
+
+  //Exchange commands and feedback with a node on the same host through
+  //shared memory, with the topics as a fallback
+  this->shared_memory = true;
+  if (_sdf->HasElement("sharedMemory")) {
+    this->shared_memory = _sdf->GetElement("sharedMemory")->Get<bool>();
+  }
+  else {
+    this->n->param<bool>("hebiros/shared_memory", this->shared_memory, true);
+  }
+
+  //Groups can be stepped in parallel, on <updateThreads> threads counting
+  //the physics thread. A group's step only takes microseconds, about as long
+  //as waking a thread, so this only pays off for many groups with many
+  //joints; by default groups are stepped on the physics thread. The step
+  //time is logged at debug level, to compare settings on a given host.
+  //More threads than cores only add wake-up latency to every iteration, so
+  //the count is limited to the host's cores.
+  int update_threads = 1;
+  if (_sdf->HasElement("updateThreads")) {
+    update_threads = _sdf->GetElement("updateThreads")->Get<int>();
+  }
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  if (cores > 0 && update_threads > cores) {
+    ROS_WARN("updateThreads is %d, but the host has %d cores; using %d threads",
+      update_threads, cores, cores);
+    update_threads = cores;
+  }
+  this->worker_pool.Start(std::max(update_threads, 1) - 1);
+  if (this->worker_pool.Size() > 1) {
+    ROS_INFO("Stepping groups on %zu threads", this->worker_pool.Size());
+  }
+
+  this->add_group_srv =
+    this->n->advertiseService<AddGroupFromNamesSrv::Request, AddGroupFromNamesSrv::Response>(
+    "hebiros_gazebo_plugin/add_group", boost::bind(
+    &HebirosGazeboGroupManager::SrvAddGroup, this, _1, _2));
+}
+
+//Update the joints at every simulation iteration. Groups do not share any
+//controller state, so they are stepped in parallel; only the forces are then
+//applied to Gazebo, from this thread.
+void HebirosGazeboGroupManager::OnUpdate(const common::UpdateInfo & _info) {
+  ros::Time current_time = this->lockstep ?
+    ros::Time(_info.simTime.sec, _info.simTime.nsec) : ros::Time::now();
+
+  this->update_groups.clear();
+  {
+    std::lock_guard<std::mutex> lock(this->groups_mutex);
+    for (auto& group_pair : hebiros_groups) {
+      this->update_groups.push_back(group_pair.second);
+    }
+  }
+
+  auto step_start = std::chrono::steady_clock::now();
+  this->worker_pool.Run(this->update_groups.size(), [this, &current_time](size_t i) {
+    StepGroup(this->update_groups[i], current_time);
+  });
+  this->step_time += std::chrono::steady_clock::now() - step_start;
+  if (++this->step_time_count == STEP_TIME_ITERATIONS) {
+    ROS_DEBUG("Stepped %zu groups on %zu threads in %.2f us per iteration",
+      this->update_groups.size(), this->worker_pool.Size(),
+      std::chrono::duration<double, std::micro>(this->step_time).count() / STEP_TIME_ITERATIONS);
+    this->step_time = std::chrono::steady_clock::duration::zero();
+    this->step_time_count = 0;
+  }
+
+  for (auto& hebiros_group : this->update_groups) {
+    ApplyForces(hebiros_group);
+  }
+}
+
+//Advance a group by one iteration; runs on any thread of the worker pool
+void HebirosGazeboGroupManager::StepGroup(const std::shared_ptr<HebirosGazeboGroup>& hebiros_group,
+  const ros::Time& current_time) {
+
+  hebiros_group->command_active = false;
+  if (!hebiros_group->group_added.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  if (this->lockstep && hebiros_group->awaiting_command) {
+    hebiros_group->awaiting_command = false;
+    if (!hebiros_group->WaitForCommand(
+      std::chrono::duration<double>(this->lockstep_timeout))) {
+      ROS_WARN("No command for group %s after feedback; continuing",
+        hebiros_group->name.c_str());
+    }
+  }
+
+  // Take a newly received command, timed from when it arrived; in lockstep
+  // mode, from the step that takes it
+  if (hebiros_group->controller.acquireCommand()) {
+    if (this->lockstep) {
+      hebiros_group->start_time = current_time;
+    }
+    else {
+      hebiros_group->start_time = hebiros_group->controller.getCommand().time;
+      hebiros_group->prev_time = hebiros_group->start_time;
+    }
+  }
+
+  // Get the time elapsed since the last iteration
+  ros::Duration iteration_time = current_time - hebiros_group->prev_time;
+  hebiros_group->prev_time = current_time;
+  UpdateGroup(hebiros_group, current_time, iteration_time);
+}
+
+//Apply the forces computed by the last step of a group
+void HebirosGazeboGroupManager::ApplyForces(const std::shared_ptr<HebirosGazeboGroup>& hebiros_group) {
+
+  if (!hebiros_group->command_active) {
+    return;
+  }
+
+  const hebiros::sim::ActuatorController& controller = hebiros_group->controller;
+  for (auto& joint_pair : hebiros_group->joints) {
+    const std::shared_ptr<HebirosGazeboJoint>& hebiros_joint = joint_pair.second;
+    if (hebiros_joint->joint) {
+      hebiros_joint->joint->SetForce(0, controller.force[hebiros_joint->feedback_index]);
+    }
+  }
+}
+
+//Read the joints, compute the forces of a group and publish feedback
+void HebirosGazeboGroupManager::UpdateGroup(std::shared_ptr<HebirosGazeboGroup> hebiros_group,
+  const ros::Time& current_time, const ros::Duration& iteration_time) {
+
+  ros::Duration elapsed_time = current_time - hebiros_group->start_time;
+  ros::Duration feedback_time = current_time - hebiros_group->prev_feedback_time;
+  hebiros::sim::ActuatorController& controller = hebiros_group->controller;
+
+  //Read the state of every joint, and report the temperatures from before
+  //this iteration
+  for (auto& joint_pair : hebiros_group->joints) {
+
+    const std::shared_ptr<HebirosGazeboJoint>& hebiros_joint = joint_pair.second;
+    const physics::JointPtr& joint = hebiros_joint->joint;
+
+    //Groups of the world plugin outlive the models they were made of; a
+    //removed model's joints lose their links, and are no longer simulated
+    if (joint && !joint->GetChild()) {
+      ROS_WARN("Joint %s of group %s was removed from the world",
+        hebiros_joint->name.c_str(), hebiros_group->name.c_str());
+      hebiros_joint->joint.reset();
+      hebiros_joint->model.reset();
+      hebiros_joint->imu.reset();
+      hebiros_joint->imu_link.reset();
+    }
+
+    if (joint) {
+
+      int i = hebiros_joint->feedback_index;
+
+      double position = joint->GetAngle(0).Radian();
+      double velocity = joint->GetVelocity(0);
+      physics::JointWrench wrench = joint->GetForceTorque(0);
+      auto trans = joint->GetChild()->GetInitialRelativePose().rot;
+      double effort = (-1 * (trans * wrench.body1Torque)).z;
+
+      controller.position[i] = position;
+      controller.velocity[i] = velocity;
+      controller.effort[i] = effort;
+
+      hebiros_group->feedback.position[i] = position;
+      hebiros_group->feedback.velocity[i] = velocity;
+      hebiros_group->feedback.effort[i] = effort;
+
+      hebiros_joint->UpdateIMU();
+      hebiros_group->feedback.accelerometer[i] = hebiros_joint->accelerometer;
+      hebiros_group->feedback.gyro[i] = hebiros_joint->gyro;
+      hebiros_group->feedback.orientation[i] = hebiros_joint->orientation;
+
+      // Add temperature feedback
+      hebiros_group->feedback.motor_winding_temperature[i] = controller.winding_temperature[i];
+      hebiros_group->feedback.motor_housing_temperature[i] = controller.housing_temperature[i];
+      hebiros_group->feedback.board_temperature[i] = controller.body_temperature[i];
+    }
+  }
+
+  if (controller.hasCommand()) {
+
+    //Compute the forces of all joints at once; ApplyForces applies them
+    controller.update(iteration_time.toSec());
+    const hebiros::sim::ActuatorController::Command& command = controller.getCommand();
+
+    hebiros_group->command_active = (hebiros_group->command_lifetime == 0) ||
+      (elapsed_time.toSec() <= hebiros_group->command_lifetime/1000.0);
+
+    for (auto& joint_pair : hebiros_group->joints) {
+
+      const std::shared_ptr<HebirosGazeboJoint>& hebiros_joint = joint_pair.second;
+
+      if (hebiros_joint->joint) {
+
+        int i = hebiros_joint->feedback_index;
+
+        if (command.has_position_target[i]) {
+          hebiros_group->feedback.position_command[i] = command.position_target[i];
+        }
+        if (command.has_velocity_target[i]) {
+          hebiros_group->feedback.velocity_command[i] = command.velocity_target[i];
+        }
+        if (command.has_effort_target[i]) {
+          hebiros_group->feedback.effort_command[i] = command.effort_target[i];
+        }
+      }
+    }
+  }
+
+  //Hand a snapshot to the publishing thread; the copy reuses the snapshot's
+  //storage, so this does not allocate once the group is running
+  bool feedback_due;
+  if (this->lockstep) {
+    feedback_due = (hebiros_group->step_count++ % this->feedback_decimation == 0);
+  }
+  else {
+    feedback_due = (feedback_time.toSec() >= 1.0/hebiros_group->feedback_frequency);
+  }
+
+  if (!hebiros_group->feedback_pub.getTopic().empty() && feedback_due) {
+
+    //Once the node commands the group, it replies to each feedback in
+    //lockstep mode, and the next step waits for that reply
+    if (this->lockstep && controller.hasCommand()) {
+      hebiros_group->ExpectCommand();
+      hebiros_group->awaiting_command = true;
+    }
+
+    hebiros_group->feedback_buffer.back() = hebiros_group->feedback;
+    hebiros_group->feedback_buffer.publish();
+    feedback_publisher.Notify();
+    hebiros_group->prev_feedback_time = current_time;
+  }
+}
+
+//Service callback which adds a group with corresponding joints
+bool HebirosGazeboGroupManager::SrvAddGroup(AddGroupFromNamesSrv::Request &req,
+  AddGroupFromNamesSrv::Response &res) {
+
+  {
+    std::lock_guard<std::mutex> lock(this->groups_mutex);
+    if (hebiros_groups.find(req.group_name) != hebiros_groups.end()) {
+      ROS_WARN("Group %s already exists", req.group_name.c_str());
+      return true;
+    }
+  }
+
+  //Set the group up completely before the threads stepping groups and
+  //receiving commands can see it
+  std::shared_ptr<HebirosGazeboGroup> hebiros_group =
+    std::make_shared<HebirosGazeboGroup>(req.group_name, this->n);
+
+  for (int i = 0; i < req.families.size(); i++) {
+    for (int j = 0; j < req.names.size(); j++) {
+
+      if ((req.families.size() == 1) ||
+        (req.families.size() == req.names.size() && i == j)) {
+
+        std::string joint_name = req.families[i]+"/"+req.names[j];
+        hebiros_group->feedback.name.push_back(joint_name);
+
+        AddJointToGroup(hebiros_group, joint_name);
+      }
+    }
+  }
+
+  int size = hebiros_group->joints.size();
+
+  hebiros_group->feedback.position.resize(size);
+  hebiros_group->feedback.motor_winding_temperature.resize(size);
+  hebiros_group->feedback.motor_housing_temperature.resize(size);
+  hebiros_group->feedback.board_temperature.resize(size);
+  hebiros_group->feedback.velocity.resize(size);
+  hebiros_group->feedback.effort.resize(size);
+  hebiros_group->feedback.position_command.resize(size);
+  hebiros_group->feedback.velocity_command.resize(size);
+  hebiros_group->feedback.effort_command.resize(size);
+  hebiros_group->feedback.accelerometer.resize(size);
+  hebiros_group->feedback.gyro.resize(size);
+  hebiros_group->feedback.orientation.resize(size);
+
+  hebiros_group->feedback_pub = this->n->advertise<FeedbackMsg>(
+    "hebiros_gazebo_plugin/feedback/"+req.group_name, 100);
+
+  if (this->shared_memory) {
+    hebiros_group->OpenSharedMemory(this->n);
+  }
+
+  feedback_publisher.AddGroup(hebiros_group);
+  if (hebiros_group->command_ring) {
+    command_receiver.AddGroup(hebiros_group);
+  }
+  hebiros_group->group_added.store(true, std::memory_order_release);
+
+  std::lock_guard<std::mutex> lock(this->groups_mutex);
+  hebiros_groups[req.group_name] = hebiros_group;
+
+  return true;
+}
+
+//Add a joint to an associated group
+void HebirosGazeboGroupManager::AddJointToGroup(std::shared_ptr<HebirosGazeboGroup> hebiros_group,
+  std::string joint_name) {
+
+  //The actuator type is the last part of the Gazebo joint's name
+  std::string model_name = "";
+  physics::ModelPtr model;
+  for (const char* actuator : {"X5_1", "X5_4", "X5_9", "X8_3", "X8_9", "X8_16"}) {
+    model = this->find_model(joint_name+"/"+actuator);
+    if (model) {
+      model_name = actuator;
+      break;
+    }
+  }
+  bool is_x8 = hebiros::sim::ActuatorSettings::isX8(model_name);
+
+  std::shared_ptr<HebirosGazeboJoint> hebiros_joint =
+    std::make_shared<HebirosGazeboJoint>(joint_name, model_name);
+
+  // Look the Gazebo joint up once; the update loop uses this pointer directly
+  if (model) {
+    hebiros_joint->model = model;
+    hebiros_joint->joint = model->GetJoint(joint_name+"/"+model_name);
+  }
+  if (hebiros_joint->joint) {
+    hebiros_joint->joint->SetProvideFeedback(true);
+  }
+  else {
+    ROS_WARN("Joint %s not found", joint_name.c_str());
+  }
+
+  hebiros_joint->feedback_index = hebiros_group->joints.size();
+  hebiros_joint->command_index = hebiros_joint->feedback_index;
+  hebiros_group->command_indices.push_back(hebiros_joint->command_index);
+
+  HebirosGazeboController::SetSettings(hebiros_group, hebiros_joint);
+  hebiros_group->joints[joint_name] = hebiros_joint;
+
+  hebiros_group->controller.addJoint(hebiros_joint->gear_ratio, is_x8, is_x8 ?
+    hebiros::sim::TemperatureModel::createX8() :
+    hebiros::sim::TemperatureModel::createX5());
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+#include <gazebo/common/common.hh>
+#include <gazebo/physics/physics.hh>
+
+#include "ros/ros.h"
+
+#include "hebiros/AddGroupFromNamesSrv.h"
+
+#include "hebiros_gazebo_group.h"
+#include "hebiros_gazebo_joint.h"
+#include "hebiros_gazebo_controller.h"
+#include "hebiros_gazebo_command_receiver.h"
+#include "hebiros_gazebo_feedback_publisher.h"
+#include "hebiros_gazebo_worker_pool.h"
+
+using namespace hebiros;
+using namespace gazebo;
+
+// The groups of a plugin: the add_group service, one update of all groups per
+// simulation step, and the threads that publish their feedback and receive
+// their commands through shared memory. The model plugin finds joints in its
+// own model; the world plugin in any model of the world, so that one manager
+// serves a whole fleet.
+class HebirosGazeboGroupManager {
+
+public:
+
+  // Returns the model with a joint of the given full name
+  // ("family/name/X5_1"), or null
+  typedef std::function<physics::ModelPtr(const std::string&)> ModelLookup;
+
+  HebirosGazeboGroupManager() = default;
+
+  // Reads the options of the plugin's SDF element, and advertises the
+  // add_group service on "n"
+  void Load(std::shared_ptr<ros::NodeHandle> n, sdf::ElementPtr _sdf,
+    ModelLookup find_model);
+  void OnUpdate(const common::UpdateInfo & _info);
+
+private:
+
+  ModelLookup find_model;
+  // Groups are added from the ROS callback thread while the physics thread
+  // steps them
+  std::map<std::string, std::shared_ptr<HebirosGazeboGroup>> hebiros_groups;
+  std::mutex groups_mutex;
+  HebirosGazeboFeedbackPublisher feedback_publisher;
+  HebirosGazeboCommandReceiver command_receiver;
+  HebirosGazeboWorkerPool worker_pool;
+  // Groups stepped in the current iteration; reused across iterations
+  std::vector<std::shared_ptr<HebirosGazeboGroup>> update_groups;
+
+  // Time spent stepping groups, logged at debug level every
+  // STEP_TIME_ITERATIONS iterations, to compare <updateThreads> settings
+  static constexpr int STEP_TIME_ITERATIONS = 10000;
+  std::chrono::steady_clock::duration step_time {};
+  int step_time_count = 0;
+
+  bool lockstep = false;
+  int feedback_decimation = 1;
+  double lockstep_timeout = 1.0;
+  bool shared_memory = true;
+  std::shared_ptr<ros::NodeHandle> n;
+  ros::ServiceServer add_group_srv;
+
+  void AddJointToGroup(std::shared_ptr<HebirosGazeboGroup> hebiros_group, std::string joint_name);
+  void StepGroup(const std::shared_ptr<HebirosGazeboGroup>& hebiros_group,
+    const ros::Time& current_time);
+  void UpdateGroup(std::shared_ptr<HebirosGazeboGroup> hebiros_group,
+    const ros::Time& current_time, const ros::Duration& iteration_time);
+  void ApplyForces(const std::shared_ptr<HebirosGazeboGroup>& hebiros_group);
+
+  bool SrvAddGroup(AddGroupFromNamesSrv::Request &req, AddGroupFromNamesSrv::Response &res);
+
+};
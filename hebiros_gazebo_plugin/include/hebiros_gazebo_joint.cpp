@@ -1,26 +1,77 @@
 #include <hebiros_gazebo_joint.h>
 
+#include "hebiros/sim/hebiros_actuator_settings.h"
+
+constexpr std::chrono::seconds HebirosGazeboJoint::IMU_LOOKUP_PERIOD;
+
 HebirosGazeboJoint::HebirosGazeboJoint(const std::string& name_,
-  const std::string& model_name_,
-  bool is_x8, // TODO: do this better...
-  std::shared_ptr<ros::NodeHandle> n)
-  : name(name_), model_name(model_name_),
-    temperature(is_x8 ?
-      hebiros::sim::TemperatureModel::createX8() :
-      hebiros::sim::TemperatureModel::createX5()) {
-  this->imu_subscriber = n->subscribe<sensor_msgs::Imu>(
-    "hebiros_gazebo_plugin/imu/"+name,
-    100, boost::bind(&HebirosGazeboJoint::SubIMU, this, _1));
+  const std::string& model_name_)
+  : name(name_), model_name(model_name_) {
 }
 
-//Subscriber which receives IMU feedback from gazebo
-void HebirosGazeboJoint::SubIMU(const boost::shared_ptr<sensor_msgs::Imu const> data) {
-  this->accelerometer = data->linear_acceleration;
-  this->gyro = data->angular_velocity;
+//Look up the IMU sensor of the module, which Gazebo may create after the
+//joint is added to a group. Every model of a robot has sensors of the same
+//names, so only the sensors of the joint's own model are considered, by the
+//scoped names ("world::model::link::sensor") that its links list.
+bool HebirosGazeboJoint::FindIMU() {
+  auto now = std::chrono::steady_clock::now();
+  if (now < this->next_imu_lookup) {
+    return false;
+  }
+  this->next_imu_lookup = now + IMU_LOOKUP_PERIOD;
+
+  if (!this->model) {
+    this->imu = std::dynamic_pointer_cast<gazebo::sensors::ImuSensor>(
+      gazebo::sensors::SensorManager::Instance()->GetSensor(this->name+"/imu_sensor"));
+    return static_cast<bool>(this->imu);
+  }
+
+  std::string sensor_suffix = "::"+this->name+"/imu_sensor";
+  for (const gazebo::physics::LinkPtr& link : this->model->GetLinks()) {
+    for (unsigned int i = 0; i < link->GetSensorCount(); i++) {
+      std::string sensor_name = link->GetSensorName(i);
+      if (sensor_name.size() < sensor_suffix.size() || sensor_name.compare(
+        sensor_name.size() - sensor_suffix.size(), sensor_suffix.size(), sensor_suffix) != 0) {
+        continue;
+      }
+      this->imu = std::dynamic_pointer_cast<gazebo::sensors::ImuSensor>(
+        gazebo::sensors::SensorManager::Instance()->GetSensor(sensor_name));
+      if (this->imu) {
+        this->imu_link = link;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+//Read the accelerometer, gyro and orientation of the module's IMU
+void HebirosGazeboJoint::UpdateIMU() {
+  if (!this->imu && !FindIMU()) {
+    return;
+  }
+
+  ignition::math::Vector3d linear_acceleration = this->imu->LinearAcceleration();
+  this->accelerometer.x = linear_acceleration.X();
+  this->accelerometer.y = linear_acceleration.Y();
+  this->accelerometer.z = linear_acceleration.Z();
+
+  ignition::math::Vector3d angular_velocity = this->imu->AngularVelocity();
+  this->gyro.x = angular_velocity.X();
+  this->gyro.y = angular_velocity.Y();
+  this->gyro.z = angular_velocity.Z();
+
+  //The sensor reports its orientation relative to where it started; the
+  //modules report theirs in the world frame, as given by the link
+  ignition::math::Quaterniond rotation = this->imu_link ?
+    this->imu_link->GetWorldPose().Ign().Rot() * this->imu->Pose().Rot() :
+    this->imu->Orientation();
+  this->orientation.w = rotation.W();
+  this->orientation.x = rotation.X();
+  this->orientation.y = rotation.Y();
+  this->orientation.z = rotation.Z();
 }
 
 bool HebirosGazeboJoint::isX8() const {
-  return (model_name == "X8_3" || 
-          model_name == "X8_9" ||
-          model_name == "X8_16");
+  return hebiros::sim::ActuatorSettings::isX8(model_name);
 }
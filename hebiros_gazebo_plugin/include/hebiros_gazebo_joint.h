@@ -1,10 +1,14 @@
 #pragma once
 
+#include <chrono>
+
+#include <gazebo/physics/physics.hh>
+#include <gazebo/sensors/sensors.hh>
+
 #include "ros/ros.h"
-#include "sensor_msgs/Imu.h"
+#include "geometry_msgs/Quaternion.h"
 #include "geometry_msgs/Vector3.h"
-#include "hebiros_temperature_model.h"
-#include "temperature_safety_controller.h"
+#include "hebiros/sim/hebiros_actuator_settings.h"
 
 class HebirosGazeboJoint : public std::enable_shared_from_this<HebirosGazeboJoint> {
 
@@ -15,28 +19,41 @@ public:
   std::string model_name;
   geometry_msgs::Vector3 accelerometer;
   geometry_msgs::Vector3 gyro;
+  geometry_msgs::Quaternion orientation;
 
   int feedback_index;
   int command_index;
 
-  hebiros::sim::TemperatureModel temperature;
-  hebiros::sim::TemperatureSafetyController temperature_safety{155};
+  // The Gazebo joint and its model, resolved once when the joint is added to
+  // a group; null if no model has a joint by this name.
+  gazebo::physics::ModelPtr model;
+  gazebo::physics::JointPtr joint;
 
   double prev_force {};
   double low_pass_alpha {};
   double gear_ratio {};
-  double position_prev_error {};
-  double position_elapsed_error {};
-  double velocity_prev_error {};
-  double velocity_elapsed_error {};
-  double effort_prev_error {};
-  double effort_elapsed_error {};
+  // Default gains of the joint's model, by control strategy
+  const hebiros::sim::ActuatorSettings::GainsTable* default_gains {};
 
-  ros::Subscriber imu_subscriber;
+  // The IMU sensor of the module ("<name>/imu_sensor" on a link of "model"),
+  // read directly from Gazebo's sensor manager, and the link it is attached
+  // to; null until Gazebo has created the sensor.
+  gazebo::sensors::ImuSensorPtr imu;
+  gazebo::physics::LinkPtr imu_link;
 
-  HebirosGazeboJoint(const std::string& name, const std::string& model_name, bool is_x8, std::shared_ptr<ros::NodeHandle> n);
+  HebirosGazeboJoint(const std::string& name, const std::string& model_name);
 
-  void SubIMU(const boost::shared_ptr<sensor_msgs::Imu const> data);
+  // Reads the IMU into accelerometer, gyro and orientation; the sensor is
+  // looked up again at most once per IMU_LOOKUP_PERIOD until it is found
+  void UpdateIMU();
   bool isX8() const;
 
+private:
+
+  static constexpr std::chrono::seconds IMU_LOOKUP_PERIOD {1};
+
+  std::chrono::steady_clock::time_point next_imu_lookup;
+
+  bool FindIMU();
+
 };
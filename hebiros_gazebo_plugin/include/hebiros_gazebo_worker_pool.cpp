@@ -0,0 +1,82 @@
+#include <hebiros_gazebo_worker_pool.h>
+
+HebirosGazeboWorkerPool::~HebirosGazeboWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->running = false;
+  }
+  this->start_condition.notify_all();
+  for (auto& thread : this->threads) {
+    thread.join();
+  }
+}
+
+void HebirosGazeboWorkerPool::Start(size_t thread_count) {
+  for (size_t i = 0; i < thread_count; i++) {
+    this->threads.emplace_back(&HebirosGazeboWorkerPool::Work, this);
+  }
+}
+
+size_t HebirosGazeboWorkerPool::Size() const {
+  return this->threads.size() + 1;
+}
+
+void HebirosGazeboWorkerPool::Run(size_t count,
+  const std::function<void(size_t)>& task) {
+
+  if (this->threads.empty() || count <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->task = &task;
+    this->count = count;
+    this->next.store(0, std::memory_order_relaxed);
+    this->busy = this->threads.size();
+    this->generation++;
+  }
+  this->start_condition.notify_all();
+
+  RunTasks();
+
+  //Workers may still be finishing their last iteration
+  std::unique_lock<std::mutex> lock(this->mutex);
+  this->done_condition.wait(lock, [this] { return this->busy == 0; });
+  this->task = nullptr;
+}
+
+//Take iterations of the current loop until there are none left
+void HebirosGazeboWorkerPool::RunTasks() {
+  size_t i;
+  while ((i = this->next.fetch_add(1, std::memory_order_relaxed)) < this->count) {
+    (*this->task)(i);
+  }
+}
+
+//Join each loop as it is started, until the pool is destroyed
+void HebirosGazeboWorkerPool::Work() {
+  uint64_t generation = 0;
+  std::unique_lock<std::mutex> lock(this->mutex);
+
+  while (true) {
+    this->start_condition.wait(lock, [this, generation] {
+      return !this->running || this->generation != generation;
+    });
+    if (!this->running) {
+      return;
+    }
+    generation = this->generation;
+
+    lock.unlock();
+    RunTasks();
+    lock.lock();
+
+    if (--this->busy == 0) {
+      this->done_condition.notify_one();
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small set of persistent threads that run the iterations of a loop in
+// parallel with the calling thread. Threads are started once, when the
+// plugin loads, and wait between loops, so a physics step does not start or
+// stop threads.
+class HebirosGazeboWorkerPool {
+
+public:
+
+  HebirosGazeboWorkerPool() = default;
+  ~HebirosGazeboWorkerPool();
+
+  //Start the worker threads; the pool runs loops on thread_count + 1
+  //threads, counting the caller
+  void Start(size_t thread_count);
+
+  size_t Size() const;
+
+  //Run task(i) for every i in [0, count) and return once all have finished.
+  //Iterations are handed out one at a time, to the workers and the calling
+  //thread alike; with no workers, or a single iteration, the caller runs
+  //them all.
+  void Run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable start_condition;
+  std::condition_variable done_condition;
+  bool running = true;
+
+  // Current loop; "generation" counts loops, so that a worker runs each one
+  // once, and "busy" counts the workers still inside it
+  const std::function<void(size_t)>* task = nullptr;
+  size_t count = 0;
+  std::atomic<size_t> next {0};
+  uint64_t generation = 0;
+  size_t busy = 0;
+
+  void RunTasks();
+  void Work();
+
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <gazebo/common/common.hh>
+#include <gazebo/gazebo.hh>
+#include <gazebo/physics/physics.hh>
+
+#include "ros/ros.h"
+
+#include "hebiros_gazebo_group_manager.h"
+
+using namespace hebiros;
+using namespace gazebo;
+
+// Simulates the HEBI modules of every model in the world, with one update
+// callback, one node handle and one feedback publishing thread for all groups.
+// Groups may be made of joints of any model, so the models must not share
+// family and module names; they are loaded without HebirosGazeboPlugin.
+// Takes the same SDF elements as HebirosGazeboPlugin.
+class HebirosGazeboWorldPlugin: public WorldPlugin {
+
+public:
+  HebirosGazeboWorldPlugin() = default;
+
+  void Load(physics::WorldPtr _world, sdf::ElementPtr _sdf);
+
+private:
+
+  physics::WorldPtr world;
+  event::ConnectionPtr update_connection;
+  HebirosGazeboGroupManager group_manager;
+
+  std::string robot_namespace;
+  std::shared_ptr<ros::NodeHandle> n;
+
+  physics::ModelPtr FindModel(const std::string& joint_name) const;
+
+};
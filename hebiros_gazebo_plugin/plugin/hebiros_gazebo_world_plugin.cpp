@@ -0,0 +1,43 @@
+#include <hebiros_gazebo_world_plugin.h>
+
+//Load the world and sdf from Gazebo
+void HebirosGazeboWorldPlugin::Load(physics::WorldPtr _world, sdf::ElementPtr _sdf) {
+  this->world = _world;
+
+  int argc = 0;
+  char **argv = NULL;
+  ros::init(argc, argv, "hebiros_gazebo_plugin_node");
+
+  this->robot_namespace = "";
+  if (_sdf->HasElement("robotNamespace")) {
+    this->robot_namespace = _sdf->GetElement("robotNamespace")->Get<std::string>();
+  }
+  if (this->robot_namespace == "") {
+    this->n.reset(new ros::NodeHandle);
+  } else {
+    this->n.reset(new ros::NodeHandle(this->robot_namespace));
+  }
+
+  //Groups are made of joints of any model, including models spawned after
+  //the world is loaded
+  this->group_manager.Load(this->n, _sdf, boost::bind(
+    &HebirosGazeboWorldPlugin::FindModel, this, _1));
+
+  this->update_connection = event::Events::ConnectWorldUpdateBegin (
+    boost::bind(&HebirosGazeboGroupManager::OnUpdate, &this->group_manager, _1));
+
+  ROS_INFO("Loaded hebiros gazebo world plugin");
+}
+
+//Find the model with a joint, when a group is added
+physics::ModelPtr HebirosGazeboWorldPlugin::FindModel(const std::string& joint_name) const {
+  for (const physics::ModelPtr& model : this->world->GetModels()) {
+    if (model->GetJoint(joint_name)) {
+      return model;
+    }
+  }
+  return physics::ModelPtr();
+}
+
+//Tell Gazebo about this plugin
+GZ_REGISTER_WORLD_PLUGIN(HebirosGazeboWorldPlugin);